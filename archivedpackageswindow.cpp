@@ -1,50 +1,30 @@
 #include "archivedpackageswindow.h"
+#include "archivemodel.h"
 #include <QMenu>
 #include <QAction>
-#include <QSettings>
-#include <QMap>
-#include <QVariant>
-#include <QListWidgetItem>
 
-ArchivedPackagesWindow::ArchivedPackagesWindow(QWidget *parent)
-    : QDialog(parent)
+ArchivedPackagesWindow::ArchivedPackagesWindow(ArchiveModel *model, QWidget *parent)
+    : QDialog(parent), model(model)
 {
     setWindowTitle("Archived Packages");
     layout = new QVBoxLayout(this);
     
-    archivedList = new QListWidget(this);
+    archivedList = new QListView(this);
+    archivedList->setModel(model);
+    archivedList->setUniformItemSizes(true);
     archivedList->setContextMenuPolicy(Qt::CustomContextMenu);
     layout->addWidget(archivedList);
     
-    connect(archivedList, &QListWidget::customContextMenuRequested,
+    connect(archivedList, &QListView::customContextMenuRequested,
             this, &ArchivedPackagesWindow::onItemContextMenuRequested);
-    
-    refreshList();
 }
 
 ArchivedPackagesWindow::~ArchivedPackagesWindow() {}
 
-void ArchivedPackagesWindow::refreshList()
-{
-    archivedList->clear();
-    
-    QSettings settings;
-    QStringList savedPackages = settings.value("trackingNumbers").toStringList();
-    QMap<QString, QVariant> archivedMap = settings.value("packageArchived").toMap();
-    
-    for (const QString &trackingNumber : savedPackages) {
-        bool isArchived = archivedMap.contains(trackingNumber) ? archivedMap[trackingNumber].toBool() : false;
-        if (isArchived) {
-            auto item = new QListWidgetItem(trackingNumber);
-            archivedList->addItem(item);
-        }
-    }
-}
-
 void ArchivedPackagesWindow::onItemContextMenuRequested(const QPoint &pos)
 {
-    QListWidgetItem* item = archivedList->itemAt(pos);
-    if (!item)
+    QModelIndex index = archivedList->indexAt(pos);
+    if (!index.isValid())
         return;
     
     QMenu contextMenu;
@@ -55,12 +35,10 @@ void ArchivedPackagesWindow::onItemContextMenuRequested(const QPoint &pos)
 
 void ArchivedPackagesWindow::unarchiveSelected()
 {
-    QListWidgetItem* item = archivedList->currentItem();
-    if (!item)
+    QModelIndex index = archivedList->currentIndex();
+    if (!index.isValid())
         return;
     
-    QString trackingNumber = item->text();
-    emit requestUnarchive(trackingNumber);
-    
-    delete archivedList->takeItem(archivedList->row(item));
-} 
\ No newline at end of file
+    // MainWindow removes the row from the shared model once it's unarchived
+    emit requestUnarchive(model->trackingNumberAt(index.row()));
+}
@@ -2,15 +2,18 @@
 #define ARCHIVEDPACKAGESWINDOW_H
 
 #include <QDialog>
-#include <QListWidget>
+#include <QListView>
 #include <QVBoxLayout>
 
+class ArchiveModel;
+
+// View over MainWindow's ArchiveModel; rows are loaded page by page as the
+// list scrolls and stay in sync while the dialog is open.
 class ArchivedPackagesWindow : public QDialog {
     Q_OBJECT
 public:
-    explicit ArchivedPackagesWindow(QWidget *parent = nullptr);
+    explicit ArchivedPackagesWindow(ArchiveModel *model, QWidget *parent = nullptr);
     ~ArchivedPackagesWindow();
-    void refreshList();
 
 signals:
     // Emitted when the user wishes to unarchive a package.
@@ -21,8 +24,9 @@ private slots:
     void unarchiveSelected();
 
 private:
-    QListWidget *archivedList;
+    ArchiveModel *model;
+    QListView *archivedList;
     QVBoxLayout *layout;
 };
 
-#endif // ARCHIVEDPACKAGESWINDOW_H 
\ No newline at end of file
+#endif // ARCHIVEDPACKAGESWINDOW_H 
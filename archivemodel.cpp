@@ -0,0 +1,125 @@
+#include "archivemodel.h"
+#include "persistenceworker.h"
+#include <algorithm>
+
+ArchiveModel::ArchiveModel(PersistenceWorker* worker, QObject* parent)
+    : QAbstractListModel(parent), worker(worker)
+{
+}
+
+int ArchiveModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant ArchiveModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+
+    const PackageRow& row = rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case PackageListModel::TrackingNumberRole:
+        return row.trackingNumber;
+    case PackageListModel::StatusRole:
+        return row.status;
+    case PackageListModel::NoteRole:
+        return row.note;
+    case PackageListModel::ArchivedRole:
+        return true;
+    case PackageListModel::RenderRole:
+        if (!row.prepared) PackageListModel::prepare(row);
+        return QVariant::fromValue(&row);
+    default:
+        return QVariant();
+    }
+}
+
+bool ArchiveModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && !complete;
+}
+
+void ArchiveModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid() || complete) return;
+
+    // Served from the archive's in-memory index, so a page is cheap to wait for
+    QString after = rows.isEmpty() ? QString() : rows.last().trackingNumber;
+    QList<PackageRecord> page;
+    PersistenceWorker* archiveWorker = worker;
+    QMetaObject::invokeMethod(archiveWorker, [archiveWorker, &page, after]() {
+        page = archiveWorker->archivePage(after, ARCHIVE_PAGE_SIZE);
+    }, Qt::BlockingQueuedConnection);
+
+    complete = page.size() < ARCHIVE_PAGE_SIZE;
+    if (page.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + page.size() - 1);
+    for (const PackageRecord& record : std::as_const(page)) {
+        rows.append({ record.trackingNumber, record.status, record.note, true });
+    }
+    endInsertRows();
+}
+
+QString ArchiveModel::trackingNumberAt(int row) const
+{
+    return row >= 0 && row < rows.size() ? rows.at(row).trackingNumber : QString();
+}
+
+void ArchiveModel::addPackages(const QList<PackageRecord>& records)
+{
+    for (const PackageRecord& record : records) {
+        // Rows past the last loaded page arrive with a later fetchMore
+        if (!complete && (rows.isEmpty() || record.trackingNumber > rows.last().trackingNumber)) continue;
+        if (rowOf(record.trackingNumber) >= 0) continue;
+
+        int row = insertionRow(record.trackingNumber);
+        beginInsertRows(QModelIndex(), row, row);
+        rows.insert(row, { record.trackingNumber, record.status, record.note, true });
+        endInsertRows();
+    }
+}
+
+void ArchiveModel::removePackages(const QStringList& trackingNumbers)
+{
+    for (const QString& trackingNumber : trackingNumbers) {
+        int row = rowOf(trackingNumber);
+        if (row < 0) continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        rows.removeAt(row);
+        endRemoveRows();
+    }
+}
+
+void ArchiveModel::setNote(const QString& trackingNumber, const QString& note)
+{
+    int row = rowOf(trackingNumber);
+    if (row < 0) return;
+    rows[row].note = note;
+    rows[row].prepared = false;
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { PackageListModel::NoteRole });
+}
+
+void ArchiveModel::reload()
+{
+    beginResetModel();
+    rows.clear();
+    complete = false;
+    endResetModel();
+}
+
+int ArchiveModel::rowOf(const QString& trackingNumber) const
+{
+    int row = insertionRow(trackingNumber);
+    return row < rows.size() && rows.at(row).trackingNumber == trackingNumber ? row : -1;
+}
+
+int ArchiveModel::insertionRow(const QString& trackingNumber) const
+{
+    // Rows are kept in the archive's key order, so lookups are binary searches
+    auto it = std::lower_bound(rows.cbegin(), rows.cend(), trackingNumber,
+        [](const PackageRow& row, const QString& key) { return row.trackingNumber < key; });
+    return int(it - rows.cbegin());
+}
@@ -0,0 +1,47 @@
+#ifndef ARCHIVEMODEL_H
+#define ARCHIVEMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include "packagestore.h"
+#include "packagelistmodel.h"
+
+class PersistenceWorker;
+
+constexpr int ARCHIVE_PAGE_SIZE = 200;
+
+// List model over the archive tier, ordered by tracking number. Rows are
+// pulled from the persistence worker a page at a time as views scroll
+// (canFetchMore/fetchMore), and MainWindow keeps the loaded rows current
+// as packages are archived, unarchived or edited, so open views update in
+// place instead of being rebuilt. It answers the same roles as
+// PackageListModel, so the main list can show it directly.
+class ArchiveModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit ArchiveModel(PersistenceWorker* worker, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    QString trackingNumberAt(int row) const;
+    bool contains(const QString& trackingNumber) const { return rowOf(trackingNumber) >= 0; }
+    void addPackages(const QList<PackageRecord>& records);
+    void removePackages(const QStringList& trackingNumbers);
+    void setNote(const QString& trackingNumber, const QString& note);
+    void reload();
+
+private:
+    int rowOf(const QString& trackingNumber) const;
+    int insertionRow(const QString& trackingNumber) const;
+
+    PersistenceWorker* worker;
+    QList<PackageRow> rows;
+    bool complete = false;
+};
+
+#endif // ARCHIVEMODEL_H
@@ -0,0 +1,320 @@
+#include "archivestore.h"
+#include "resultcodec.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QtEndian>
+#include <cstring>
+#include <unistd.h>
+#include <QDebug>
+
+namespace {
+
+constexpr char ARCHIVE_MAGIC[4] = { 'P', 'T', 'A', '1' };
+constexpr int FRAME_HEADER_SIZE = 6; // quint32 body size + quint16 checksum
+constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_6_0;
+
+enum ArchiveOp : quint8 {
+    ArchivePut = 1,
+    ArchiveRemove = 2
+};
+
+QByteArray frame(const QByteArray& body)
+{
+    QByteArray framed(FRAME_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(static_cast<quint32>(body.size()), framed.data());
+    qToBigEndian<quint16>(qChecksum(body), framed.data() + 4);
+    framed.append(body);
+    return framed;
+}
+
+QByteArray encodePut(const ArchivedPackage& package)
+{
+    const PackageRecord& record = package.record;
+
+    QByteArray inner;
+    {
+        QDataStream out(&inner, QIODevice::WriteOnly);
+        out.setVersion(STREAM_VERSION);
+        out << (record.terminalSince.isValid() ? record.terminalSince.toMSecsSinceEpoch() : qint64(-1))
+            << ResultCodec::encodeResult(package.result);
+    }
+
+    // Tracking number, note, status and carrier stay uncompressed so the
+    // index can be built (and searched) without inflating anything
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+    out << static_cast<quint8>(ArchivePut) << record.trackingNumber << record.note << record.status
+        << record.carrier << qCompress(inner);
+    return frame(body);
+}
+
+QByteArray encodeRemove(const QString& trackingNumber)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+    out << static_cast<quint8>(ArchiveRemove) << trackingNumber;
+    return frame(body);
+}
+
+} // namespace
+
+ArchiveStore::ArchiveStore(const QString& path)
+    : path(path)
+{
+}
+
+ArchiveStore::~ArchiveStore()
+{
+    if (mapped) file.unmap(mapped);
+    file.close();
+}
+
+bool ArchiveStore::open()
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to open package archive:" << file.errorString();
+        return false;
+    }
+    if (file.size() == 0) {
+        file.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+        file.flush();
+    }
+
+    index.clear();
+    garbageBytes = 0;
+    if (!remap()) return false;
+
+    if (mappedSize < qint64(sizeof(ARCHIVE_MAGIC)) || std::memcmp(mapped, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+        qDebug() << "Unsupported package archive format";
+        return false;
+    }
+
+    qint64 end = indexFrom(sizeof(ARCHIVE_MAGIC));
+    if (end < mappedSize) {
+        // Drop a torn entry at the tail so new appends stay reachable
+        qDebug() << "Truncating package archive from" << mappedSize << "to" << end << "bytes";
+        file.unmap(mapped);
+        mapped = nullptr;
+        file.resize(end);
+        if (!remap()) return false;
+    }
+    return true;
+}
+
+bool ArchiveStore::openReadOnly()
+{
+    index.clear();
+    garbageBytes = 0;
+    if (!QFile::exists(path)) return true;
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open package archive:" << file.errorString();
+        return false;
+    }
+    if (!remap()) return false;
+
+    if (mappedSize < qint64(sizeof(ARCHIVE_MAGIC)) || std::memcmp(mapped, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+        qDebug() << "Unsupported package archive format";
+        return false;
+    }
+    indexFrom(sizeof(ARCHIVE_MAGIC));
+    return true;
+}
+
+bool ArchiveStore::put(const QList<ArchivedPackage>& packages)
+{
+    if (packages.isEmpty()) return true;
+
+    QByteArray frames;
+    for (const auto& package : packages) {
+        frames.append(encodePut(package));
+    }
+    return append(frames);
+}
+
+bool ArchiveStore::remove(const QStringList& trackingNumbers)
+{
+    QByteArray frames;
+    for (const QString& trackingNumber : trackingNumbers) {
+        if (index.contains(trackingNumber)) {
+            frames.append(encodeRemove(trackingNumber));
+        }
+    }
+    if (frames.isEmpty()) return true;
+
+    bool ok = append(frames);
+    compactIfNeeded();
+    return ok;
+}
+
+std::optional<ArchivedPackage> ArchiveStore::get(const QString& trackingNumber) const
+{
+    auto it = index.constFind(trackingNumber);
+    if (it == index.constEnd() || !mapped) return std::nullopt;
+
+    const IndexEntry& entry = it.value();
+    QByteArray compressed = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped) + entry.dataOffset,
+        entry.dataSize);
+    QByteArray inner = qUncompress(compressed);
+    if (inner.isEmpty()) return std::nullopt;
+
+    ArchivedPackage package;
+    package.record.trackingNumber = trackingNumber;
+    package.record.note = entry.note;
+    package.record.status = entry.status;
+    package.record.carrier = entry.carrier;
+    package.record.archived = true;
+
+    QDataStream in(inner);
+    in.setVersion(STREAM_VERSION);
+    qint64 terminalSince = -1;
+    QByteArray result;
+    in >> terminalSince >> result;
+    if (terminalSince >= 0) {
+        package.record.terminalSince = QDateTime::fromMSecsSinceEpoch(terminalSince);
+    }
+    package.result = ResultCodec::decodeResult(result);
+    return package;
+}
+
+QList<PackageRecord> ArchiveStore::search(const QString& filter) const
+{
+    QList<PackageRecord> matches;
+    QString needle = filter.toLower();
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        if (!needle.isEmpty() && !it.value().searchText.contains(needle)) continue;
+        PackageRecord record;
+        record.trackingNumber = it.key();
+        record.note = it.value().note;
+        record.status = it.value().status;
+        record.carrier = it.value().carrier;
+        record.archived = true;
+        matches.append(record);
+    }
+    return matches;
+}
+
+QList<PackageRecord> ArchiveStore::page(const QString& after, int limit) const
+{
+    // Keyset paging: stays consistent while entries are added or removed between pages
+    QList<PackageRecord> records;
+    for (auto it = after.isEmpty() ? index.constBegin() : index.upperBound(after);
+         it != index.constEnd() && records.size() < limit; ++it) {
+        PackageRecord record;
+        record.trackingNumber = it.key();
+        record.note = it.value().note;
+        record.status = it.value().status;
+        record.carrier = it.value().carrier;
+        record.archived = true;
+        records.append(record);
+    }
+    return records;
+}
+
+bool ArchiveStore::append(const QByteArray& frames)
+{
+    // Synced before returning: the caller deletes the store's copy next
+    qint64 start = file.size();
+    file.seek(start);
+    if (file.write(frames) != frames.size() || !file.flush() || ::fsync(file.handle()) != 0) {
+        qDebug() << "Failed to append to package archive:" << file.errorString();
+        // Cut off a partial write so later appends aren't stranded behind it
+        file.resize(start);
+        file.seek(start);
+        return false;
+    }
+
+    if (!remap()) return false;
+    indexFrom(start);
+    return true;
+}
+
+bool ArchiveStore::remap()
+{
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = nullptr;
+    }
+    mappedSize = file.size();
+    mapped = file.map(0, mappedSize);
+    if (!mapped) {
+        qDebug() << "Failed to map package archive:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+qint64 ArchiveStore::indexFrom(qint64 pos)
+{
+    const char* data = reinterpret_cast<const char*>(mapped);
+    while (pos + FRAME_HEADER_SIZE <= mappedSize) {
+        quint32 bodySize = qFromBigEndian<quint32>(data + pos);
+        quint16 checksum = qFromBigEndian<quint16>(data + pos + 4);
+        if (pos + FRAME_HEADER_SIZE + bodySize > mappedSize) break;
+
+        QByteArray body = QByteArray::fromRawData(data + pos + FRAME_HEADER_SIZE, bodySize);
+        if (qChecksum(body) != checksum) break;
+
+        QBuffer buffer(&body);
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream in(&buffer);
+        in.setVersion(STREAM_VERSION);
+
+        quint8 op = 0;
+        QString trackingNumber;
+        in >> op >> trackingNumber;
+
+        qint64 frameSize = FRAME_HEADER_SIZE + bodySize;
+        auto existing = index.find(trackingNumber);
+        if (existing != index.end()) {
+            garbageBytes += existing.value().frameSize;
+            index.erase(existing);
+        }
+
+        if (op == ArchivePut) {
+            IndexEntry entry;
+            quint32 compressedSize = 0;
+            in >> entry.note >> entry.status >> entry.carrier >> compressedSize;
+            entry.frameOffset = pos;
+            entry.frameSize = frameSize;
+            entry.dataOffset = pos + FRAME_HEADER_SIZE + buffer.pos();
+            entry.dataSize = compressedSize;
+            entry.searchText = trackingNumber.toLower() + QChar(0x1f) + entry.note.toLower() + QChar(0x1f)
+                + entry.carrier.toLower();
+            index.insert(trackingNumber, entry);
+        } else {
+            garbageBytes += frameSize;
+        }
+
+        pos += frameSize;
+    }
+    return pos;
+}
+
+void ArchiveStore::compactIfNeeded()
+{
+    qint64 liveBytes = mappedSize - garbageBytes;
+    if (garbageBytes < ARCHIVE_COMPACT_MIN_GARBAGE || garbageBytes < liveBytes) return;
+
+    // Copy the live entries verbatim into a fresh file
+    QSaveFile compacted(path);
+    if (!compacted.open(QIODevice::WriteOnly)) return;
+    compacted.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    const char* data = reinterpret_cast<const char*>(mapped);
+    for (const auto& entry : std::as_const(index)) {
+        compacted.write(data + entry.frameOffset, entry.frameSize);
+    }
+
+    file.unmap(mapped);
+    mapped = nullptr;
+    file.close();
+    if (!compacted.commit()) {
+        qDebug() << "Failed to compact package archive:" << compacted.errorString();
+    }
+    open();
+}
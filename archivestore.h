@@ -0,0 +1,65 @@
+#ifndef ARCHIVESTORE_H
+#define ARCHIVESTORE_H
+
+#include <QFile>
+#include <QMap>
+#include <QJsonObject>
+#include <optional>
+#include "packagestore.h"
+
+constexpr qint64 ARCHIVE_COMPACT_MIN_GARBAGE = 1024 * 1024; // don't rewrite for less than 1 MB of dead entries
+
+struct ArchivedPackage {
+    PackageRecord record;
+    QJsonObject result;
+};
+
+// Cold tier for archived packages. Each package is one compressed entry in
+// an append-only, memory-mapped file; unarchiving appends a tombstone. A
+// small in-memory index (tracking number, note, status, carrier, file offset) is
+// built when the file is opened, so listing and searching the archive never
+// decompresses anything; the full record is only inflated on lookup.
+class ArchiveStore
+{
+public:
+    explicit ArchiveStore(const QString& path);
+    ~ArchiveStore();
+
+    bool open();
+    bool openReadOnly(); // leaves a missing file missing and a torn tail in place
+    bool contains(const QString& trackingNumber) const { return index.contains(trackingNumber); }
+    int size() const { return index.size(); }
+    QStringList trackingNumbers() const { return index.keys(); }
+
+    bool put(const QList<ArchivedPackage>& packages);
+    bool remove(const QStringList& trackingNumbers);
+    std::optional<ArchivedPackage> get(const QString& trackingNumber) const;
+    QList<PackageRecord> search(const QString& filter) const;
+    QList<PackageRecord> page(const QString& after, int limit) const;
+
+private:
+    struct IndexEntry {
+        qint64 frameOffset = 0;
+        qint64 frameSize = 0;
+        qint64 dataOffset = 0;
+        quint32 dataSize = 0;
+        QString note;
+        QString status;
+        QString carrier;
+        QString searchText; // lowercased once here rather than on every search
+    };
+
+    bool append(const QByteArray& frames);
+    bool remap();
+    qint64 indexFrom(qint64 pos);
+    void compactIfNeeded();
+
+    QString path;
+    QFile file;
+    uchar* mapped = nullptr;
+    qint64 mappedSize = 0;
+    qint64 garbageBytes = 0;
+    QMap<QString, IndexEntry> index; // ordered by tracking number so it can be paged
+};
+
+#endif // ARCHIVESTORE_H
@@ -0,0 +1,42 @@
+#include "benchmark.h"
+#include "cachebenchmark.h"
+#include "delegatebenchmark.h"
+#include <QTextStream>
+
+namespace {
+
+struct Benchmark {
+    const char* name;
+    const char* unit;
+    int defaultCount;
+    int (*run)(int count);
+};
+
+const Benchmark BENCHMARKS[] = {
+    { "cache", "packages", CACHE_BENCHMARK_DEFAULT_PACKAGES, &runCacheBenchmark },
+    { "delegate", "rows", DELEGATE_BENCHMARK_DEFAULT_ROWS, &runDelegateBenchmark },
+};
+
+} // namespace
+
+int runBenchmark(const QString& name, int count)
+{
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        if (name == QLatin1String(benchmark.name)) {
+            return benchmark.run(count > 0 ? count : benchmark.defaultCount);
+        }
+    }
+
+    QTextStream err(stderr);
+    err << "Usage: PackageTracker --benchmark <name> [count]" << Qt::endl;
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        err << "    " << benchmark.name << "  (" << benchmark.defaultCount << ' ' << benchmark.unit << ")"
+            << Qt::endl;
+    }
+    return 1;
+}
+
+QString benchmarkTrackingNumber(int index)
+{
+    return QString("9400%1").arg(index, 18, 10, QChar('0'));
+}
@@ -0,0 +1,15 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+
+// Developer benchmarks, run instead of the window:
+//     PackageTracker --benchmark <name> [count]
+// Unknown names list the available benchmarks with their default counts.
+int runBenchmark(const QString& name, int count);
+
+// Tracking number for the index'th synthetic package, shared so every
+// benchmark works on the same shape of data
+QString benchmarkTrackingNumber(int index);
+
+#endif // BENCHMARK_H
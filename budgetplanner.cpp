@@ -0,0 +1,85 @@
+#include "budgetplanner.h"
+#include <QtGlobal>
+
+void BudgetPlanner::plan(const QList<Demand>& demands)
+{
+    allocation.clear();
+    projected = 0;
+
+    if (budget <= 0) {
+        // Unlimited: everyone gets what they ask for
+        for (const auto& demand : demands) {
+            projected += demand.pollsPerDay;
+        }
+        return;
+    }
+
+    QList<Demand> active;
+    for (const auto& demand : demands) {
+        if (demand.gain > 0 && demand.pollsPerDay > 0) active.append(demand);
+    }
+
+    // Water-filling: share the remaining budget by gain, saturate packages
+    // whose demand is met and hand their surplus to the rest
+    double remaining = budget;
+    while (!active.isEmpty() && remaining > 0.01) {
+        double totalGain = 0;
+        for (const auto& demand : active) totalGain += demand.gain;
+
+        QList<Demand> unsaturated;
+        double used = 0;
+        for (const auto& demand : active) {
+            double share = remaining * demand.gain / totalGain;
+            double& slots = allocation[demand.trackingNumber];
+            double wanted = demand.pollsPerDay - slots;
+            if (share >= wanted) {
+                slots = demand.pollsPerDay;
+                used += wanted;
+            } else {
+                slots += share;
+                used += share;
+                unsaturated.append(demand);
+            }
+        }
+
+        remaining -= used;
+        if (unsaturated.size() == active.size()) break;
+        active = unsaturated;
+    }
+
+    for (double slots : allocation) projected += slots;
+}
+
+qint64 BudgetPlanner::minimumInterval(const QString& trackingNumber) const
+{
+    if (budget <= 0) return 0;
+
+    double slots = allocation.value(trackingNumber, 0);
+    if (slots <= 0) return MS_PER_DAY;
+    return static_cast<qint64>(MS_PER_DAY / slots);
+}
+
+void BudgetPlanner::recordRequest(const QDate& today)
+{
+    if (currentDay != today) {
+        currentDay = today;
+        spent = 0;
+    }
+    spent++;
+}
+
+int BudgetPlanner::spentOn(const QDate& day) const
+{
+    return currentDay == day ? spent : 0;
+}
+
+bool BudgetPlanner::isExhausted(const QDate& today) const
+{
+    return budget > 0 && spentOn(today) >= budget;
+}
+
+void BudgetPlanner::restoreSpend(const QDate& day, int requests)
+{
+    currentDay = day;
+    spent = requests;
+}
@@ -0,0 +1,46 @@
+#ifndef BUDGETPLANNER_H
+#define BUDGETPLANNER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QDate>
+
+constexpr qint64 MS_PER_DAY = 24LL * 60 * 60 * 1000;
+constexpr int DEFAULT_DAILY_REQUEST_BUDGET = 0; // 0 = unlimited
+
+// Splits a daily API request budget across packages. Each package asks for
+// as many polls per day as the scheduler would like to make and carries an
+// expected information gain; the budget is handed out in proportion to gain,
+// capped at each package's demand, with any surplus redistributed.
+class BudgetPlanner
+{
+public:
+    struct Demand {
+        QString trackingNumber;
+        double gain = 0;
+        double pollsPerDay = 0;
+    };
+
+    void setDailyBudget(int requestsPerDay) { budget = requestsPerDay; }
+    int dailyBudget() const { return budget; }
+
+    void plan(const QList<Demand>& demands);
+    qint64 minimumInterval(const QString& trackingNumber) const;
+    double projectedPerDay() const { return projected; }
+
+    void recordRequest(const QDate& today);
+    int spentOn(const QDate& day) const;
+    bool isExhausted(const QDate& today) const;
+    void restoreSpend(const QDate& day, int requests);
+    QDate spendDate() const { return currentDay; }
+
+private:
+    int budget = DEFAULT_DAILY_REQUEST_BUDGET;
+    QHash<QString, double> allocation; // polls per day
+    double projected = 0;
+    QDate currentDay;
+    int spent = 0;
+};
+
+#endif // BUDGETPLANNER_H
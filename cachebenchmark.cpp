@@ -0,0 +1,112 @@
+#include "cachebenchmark.h"
+#include "benchmark.h"
+#include "resultcodec.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+constexpr int EVENTS_PER_PACKAGE = 12;
+
+QJsonObject syntheticResult(int index)
+{
+    static const QStringList statuses = { "PRE_TRANSIT", "TRANSIT", "DELIVERED", "RETURNED", "FAILURE" };
+    static const QStringList cities = { "Memphis, TN 38118", "Louisville, KY 40209", "Ontario, CA 91761",
+        "Hodgkins, IL 60525", "Atlanta, GA 30336" };
+
+    QDateTime start = QDateTime(QDate(2025, 1, 1), QTime(8, 0)).addSecs(index * 97);
+    QJsonArray events;
+    for (int i = 0; i < EVENTS_PER_PACKAGE; ++i) {
+        QJsonObject event;
+        event["id"] = QString("evt_%1_%2").arg(index, 8, 16, QChar('0')).arg(i);
+        event["timestamp"] = start.addSecs(i * 5400).toString(Qt::ISODate);
+        event["status"] = i + 1 == EVENTS_PER_PACKAGE ? statuses[index % statuses.size()] : "TRANSIT";
+        event["substatus"] = "PACKAGE_PROCESSED";
+        event["description"] = "Departed shipping partner facility";
+        event["location"] = cities[(index + i) % cities.size()];
+        events.append(event);
+    }
+
+    QJsonObject result;
+    result["tracking_number"] = benchmarkTrackingNumber(index);
+    result["carrier"] = "usps";
+    result["status"] = statuses[index % statuses.size()];
+    result["substatus"] = "PACKAGE_PROCESSED";
+    result["estimatedDelivery"] = start.addDays(3).toString(Qt::ISODate);
+    result["service"] = "Priority Mail";
+    result["fromLocation"] = cities[index % cities.size()];
+    result["toLocation"] = cities[(index + 2) % cities.size()];
+    result["events"] = events;
+    return result;
+}
+
+struct FormatResult {
+    qint64 bytes = 0;
+    qint64 encodeMs = 0;
+    qint64 decodeMs = 0;
+    qint64 events = 0; // decoded, so the work can't be skipped
+};
+
+FormatResult measure(const QList<QJsonObject>& results,
+    const std::function<QByteArray(const QJsonObject&)>& encode,
+    const std::function<QJsonObject(const QByteArray&)>& decode)
+{
+    FormatResult measured;
+    QList<QByteArray> encoded;
+    encoded.reserve(results.size());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const QJsonObject& result : results) {
+        encoded.append(encode(result));
+        measured.bytes += encoded.last().size();
+    }
+    measured.encodeMs = timer.restart();
+
+    for (const QByteArray& data : encoded) {
+        measured.events += decode(data)["events"].toArray().size();
+    }
+    measured.decodeMs = timer.elapsed();
+    return measured;
+}
+
+} // namespace
+
+int runCacheBenchmark(int packageCount)
+{
+    QTextStream out(stdout);
+
+    QList<QJsonObject> results;
+    results.reserve(packageCount);
+    for (int i = 0; i < packageCount; ++i) {
+        results.append(syntheticResult(i));
+    }
+
+    FormatResult json = measure(results,
+        [](const QJsonObject& result) { return QJsonDocument(result).toJson(QJsonDocument::Compact); },
+        [](const QByteArray& data) { return QJsonDocument::fromJson(data).object(); });
+    FormatResult cbor = measure(results, &ResultCodec::encodeResult, &ResultCodec::decodeResult);
+
+    auto report = [&out, packageCount](const QString& name, const FormatResult& format) {
+        double perSecond = format.decodeMs > 0 ? packageCount * 1000.0 / format.decodeMs : 0;
+        out << QString("%1  %2 KB  encode %3 ms  decode %4 ms  (%5 results/s, %6 events)")
+            .arg(name, -5)
+            .arg(format.bytes / 1024, 8)
+            .arg(format.encodeMs, 6)
+            .arg(format.decodeMs, 6)
+            .arg(qRound64(perSecond))
+            .arg(format.events)
+            << Qt::endl;
+    };
+
+    out << "Cached result formats, " << packageCount << " packages x " << EVENTS_PER_PACKAGE << " events"
+        << Qt::endl;
+    report("JSON", json);
+    report("CBOR", cbor);
+    return 0;
+}
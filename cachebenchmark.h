@@ -0,0 +1,11 @@
+#ifndef CACHEBENCHMARK_H
+#define CACHEBENCHMARK_H
+
+constexpr int CACHE_BENCHMARK_DEFAULT_PACKAGES = 50000;
+
+// Compares the cached-result encodings (JSON text vs ResultCodec CBOR) on a
+// synthetic data set: total size, encode time and decode throughput.
+// Run with: PackageTracker --benchmark cache [package count]
+int runCacheBenchmark(int packageCount);
+
+#endif // CACHEBENCHMARK_H
@@ -0,0 +1,82 @@
+#include "delegatebenchmark.h"
+#include "benchmark.h"
+#include "packageitemdelegate.h"
+#include "packagelistmodel.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+constexpr int BENCHMARK_VIEW_WIDTH = 420;
+
+QList<PackageRow> syntheticRows(int count)
+{
+    static const QStringList statuses = { "PRE_TRANSIT", "TRANSIT", "DELIVERED", "RETURNED", "FAILURE", "UNKNOWN" };
+    static const QStringList notes = { QString(), "Birthday present", "Replacement charger for the office laptop",
+        QString(), "Books" };
+
+    QList<PackageRow> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        PackageRow row;
+        row.trackingNumber = benchmarkTrackingNumber(i);
+        row.status = statuses[i % statuses.size()];
+        row.note = notes[i % notes.size()];
+        row.archived = i % 7 == 0;
+        rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end(), &PackageListModel::rowLess);
+    return rows;
+}
+
+qint64 paintRows(const PackageListModel& model, const PackageItemDelegate& delegate, qreal devicePixelRatio)
+{
+    QStyleOptionViewItem option;
+    option.font = QApplication::font();
+    option.palette = QApplication::palette();
+    option.state = QStyle::State_Enabled;
+    option.rect = QRect(0, 0, BENCHMARK_VIEW_WIDTH, delegate.sizeHint(option, model.index(0)).height());
+
+    // One viewport-sized image, repainted row by row like a scrolling view
+    QImage image(QSize(BENCHMARK_VIEW_WIDTH, option.rect.height()) * devicePixelRatio,
+        QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    QPainter painter(&image);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int row = 0; row < model.rowCount(); ++row) {
+        delegate.paint(&painter, option, model.index(row));
+    }
+    return timer.elapsed();
+}
+
+} // namespace
+
+int runDelegateBenchmark(int rowCount)
+{
+    QTextStream out(stdout);
+
+    PackageListModel model;
+    model.updateRows(syntheticRows(rowCount));
+    PackageItemDelegate delegate;
+
+    out << "Package list delegate, " << rowCount << " rows" << Qt::endl;
+    for (qreal ratio : { 1.0, 2.0 }) {
+        // The first pass also prepares every row's render record
+        qint64 coldMs = paintRows(model, delegate, ratio);
+        qint64 warmMs = paintRows(model, delegate, ratio);
+        double perSecond = warmMs > 0 ? rowCount * 1000.0 / warmMs : 0;
+        out << QString("%1x  first pass %2 ms  repaint %3 ms  (%4 rows/s)")
+            .arg(ratio)
+            .arg(coldMs, 6)
+            .arg(warmMs, 6)
+            .arg(qRound64(perSecond))
+            << Qt::endl;
+    }
+    return 0;
+}
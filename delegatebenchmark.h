@@ -0,0 +1,11 @@
+#ifndef DELEGATEBENCHMARK_H
+#define DELEGATEBENCHMARK_H
+
+constexpr int DELEGATE_BENCHMARK_DEFAULT_ROWS = 100000;
+
+// Paints synthetic package rows through PackageItemDelegate into an
+// offscreen image at 1x and 2x device pixel ratio and reports rows/s.
+// Run with: PackageTracker --benchmark delegate [row count]
+int runDelegateBenchmark(int rowCount);
+
+#endif // DELEGATEBENCHMARK_H
@@ -0,0 +1,550 @@
+#include "journalpackagestore.h"
+#include "resultcodec.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr quint32 SNAPSHOT_MAGIC = 0x50545331; // "PTS1"
+constexpr quint16 SNAPSHOT_VERSION = 2;     // 2 added the event section
+constexpr int JOURNAL_HEADER_SIZE = 6;      // quint32 payload size + quint16 checksum
+constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_6_0;
+
+enum JournalOp : quint8 {
+    JournalUpsert = 1,
+    JournalRemove = 2,
+    JournalResult = 3,
+    JournalEvents = 4,
+    JournalLocations = 5
+};
+
+void writeRecord(QDataStream& out, const PackageRecord& record)
+{
+    out << record.trackingNumber << record.note << record.status << record.carrier << record.archived
+        << (record.terminalSince.isValid() ? record.terminalSince.toMSecsSinceEpoch() : qint64(-1));
+}
+
+PackageRecord readRecord(QDataStream& in)
+{
+    PackageRecord record;
+    qint64 terminalSince = -1;
+    in >> record.trackingNumber >> record.note >> record.status >> record.carrier >> record.archived
+       >> terminalSince;
+    if (terminalSince >= 0) {
+        record.terminalSince = QDateTime::fromMSecsSinceEpoch(terminalSince);
+    }
+    return record;
+}
+
+// Frames one payload as [size][checksum][payload] so torn writes can be detected
+void appendEntry(QByteArray& batch, const QByteArray& payload)
+{
+    char header[JOURNAL_HEADER_SIZE];
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), header);
+    qToBigEndian<quint16>(qChecksum(payload), header + 4);
+    batch.append(header, JOURNAL_HEADER_SIZE);
+    batch.append(payload);
+}
+
+// Writes a byte array and returns where its bytes start within the stream
+qint64 writeBytes(QDataStream& out, const QByteArray& data)
+{
+    out << data;
+    return out.device()->pos() - data.size();
+}
+
+// Steps over a byte array without copying it, returning where its bytes start
+qint64 skipBytes(QDataStream& in, qint32& size)
+{
+    quint32 length = 0;
+    in >> length;
+    if (length == 0xffffffff) length = 0; // null
+    qint64 start = in.device()->pos();
+    if (in.skipRawData(length) != qint64(length)) in.setStatus(QDataStream::ReadPastEnd);
+    size = static_cast<qint32>(length);
+    return start;
+}
+
+template <typename Writer>
+QByteArray makePayload(JournalOp op, Writer write)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+    out << static_cast<quint8>(op);
+    write(out);
+    return payload;
+}
+
+} // namespace
+
+JournalPackageStore::Source::~Source()
+{
+    if (mapped) file.unmap(mapped);
+}
+
+QByteArray JournalPackageStore::Source::read(qint64 offset, qint32 size)
+{
+    if (mapped) {
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(mapped) + offset, size);
+    }
+    if (!file.seek(offset)) return QByteArray();
+    return file.read(size);
+}
+
+int JournalPackageStore::State::addSource(const QString& path, bool map)
+{
+    auto source = std::make_shared<Source>();
+    source->file.setFileName(path);
+    if (!source->file.open(QIODevice::ReadOnly)) return -1;
+    if (map && source->file.size() > 0) {
+        source->mapped = source->file.map(0, source->file.size());
+        if (!source->mapped) return -1;
+    }
+    sources.append(source);
+    return sources.size() - 1;
+}
+
+QByteArray JournalPackageStore::State::read(const Location& location) const
+{
+    if (location.source < 0 || location.source >= sources.size()) return QByteArray();
+    return sources.at(location.source)->read(location.offset, location.size);
+}
+
+JournalPackageStore::JournalPackageStore(const QString& directory)
+    : snapshotPath(directory + "/packages.snapshot"),
+      journalPath(directory + "/packages.journal"),
+      compactingPath(directory + "/packages.journal.compacting")
+{
+}
+
+JournalPackageStore::~JournalPackageStore()
+{
+    compaction.waitForFinished();
+    journal.close();
+}
+
+bool JournalPackageStore::open()
+{
+    // Finish a compaction that was interrupted by a crash. If the snapshot
+    // can't be read, the rotated journal is all that is left of it.
+    if (QFile::exists(compactingPath) && !compact(snapshotPath, compactingPath)) {
+        qDebug() << "Failed to finish package journal compaction";
+        return false;
+    }
+
+    journal.setFileName(journalPath);
+    if (!journal.open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to open package journal:" << journal.errorString();
+        return false;
+    }
+
+    // Drop a torn entry at the tail so new appends stay reachable
+    qint64 validLength = replayJournal(journalPath, nullptr);
+    if (journal.size() > validLength) {
+        qDebug() << "Truncating package journal from" << journal.size() << "to" << validLength << "bytes";
+        journal.resize(validLength);
+    }
+    journal.seek(journal.size());
+
+    // Refuse to run on an empty state when the snapshot is unreadable;
+    // the first write would otherwise bury what it holds
+    State state;
+    if (!readState(state)) {
+        journal.close();
+        return false;
+    }
+    openedRecords = state.records.values();
+    adoptIndex(state);
+    return true;
+}
+
+bool JournalPackageStore::openReadOnly()
+{
+    if (!QFile::exists(snapshotPath) && !QFile::exists(journalPath) && !QFile::exists(compactingPath)) {
+        qDebug() << "No package journal at" << journalPath;
+        return false;
+    }
+
+    // A pending compaction and a torn tail are left for the app to deal
+    // with; replay already stops at the last complete entry
+    State state;
+    if (!readState(state)) return false;
+    readOnly = true;
+    openedRecords = state.records.values();
+    adoptIndex(state);
+    return true;
+}
+
+bool JournalPackageStore::isEmpty()
+{
+    return QFileInfo(snapshotPath).size() == 0 && journal.size() == 0 && !QFile::exists(compactingPath);
+}
+
+QList<PackageRecord> JournalPackageStore::loadPackages()
+{
+    if (!openedRecords.isEmpty()) return std::exchange(openedRecords, {});
+
+    State state;
+    if (!readState(state)) return QList<PackageRecord>();
+    QList<PackageRecord> records = state.records.values();
+    adoptIndex(state);
+    return records;
+}
+
+QJsonObject JournalPackageStore::loadResult(const QString& trackingNumber)
+{
+    auto it = index.results.constFind(trackingNumber);
+    if (it == index.results.constEnd()) return QJsonObject();
+    QJsonObject result = ResultCodec::decodeResult(index.read(it.value()));
+
+    auto events = index.events.constFind(trackingNumber);
+    if (events != index.events.constEnd() && !events.value().isEmpty()) {
+        QJsonArray history;
+        for (const StoredEvent& event : events.value()) {
+            history.append(ResultCodec::decodeEvent(index.read(event.data)));
+        }
+        result["events"] = history;
+    }
+    return result;
+}
+
+QSet<QString> JournalPackageStore::loadEventIds(const QString& trackingNumber)
+{
+    QSet<QString> ids;
+    for (const StoredEvent& event : index.events.value(trackingNumber)) {
+        ids.insert(event.id);
+    }
+    return ids;
+}
+
+bool JournalPackageStore::apply(const PackageChangeSet& changes)
+{
+    if (changes.isEmpty()) return true;
+    if (readOnly) return false;
+
+    // Entries are framed first and the index only updated once they are on
+    // disk, so a failed write leaves it pointing at what is really there
+    const qint64 base = journal.size();
+    QByteArray batch;
+    auto payloadStart = [&]() { return base + batch.size() + JOURNAL_HEADER_SIZE; };
+
+    // Removals go first so a package added back in the same batch starts fresh
+    for (const QString& trackingNumber : changes.removals) {
+        appendEntry(batch, makePayload(JournalRemove, [&](QDataStream& out) { out << trackingNumber; }));
+    }
+    for (const auto& record : changes.upserts) {
+        appendEntry(batch, makePayload(JournalUpsert, [&](QDataStream& out) { writeRecord(out, record); }));
+    }
+    const QSet<QString> dropped = changes.droppedPackages();
+    for (auto it = changes.locations.constBegin(); it != changes.locations.constEnd(); ++it) {
+        if (dropped.contains(it.key())) continue;
+        appendEntry(batch, makePayload(JournalLocations, [&](QDataStream& out) { out << it.key() << it.value(); }));
+    }
+
+    QHash<QString, Location> results;
+    for (auto it = changes.results.constBegin(); it != changes.results.constEnd(); ++it) {
+        if (dropped.contains(it.key())) continue;
+        QByteArray data = ResultCodec::encodeResult(it.value());
+        Location location{ liveSource, payloadStart(), static_cast<qint32>(data.size()) };
+        appendEntry(batch, makePayload(JournalResult, [&](QDataStream& out) {
+            out << it.key();
+            location.offset += writeBytes(out, data);
+        }));
+        results.insert(it.key(), location);
+    }
+
+    QHash<QString, QList<StoredEvent>> events;
+    for (auto it = changes.newEvents.constBegin(); it != changes.newEvents.constEnd(); ++it) {
+        if (dropped.contains(it.key())) continue;
+        const QList<StoredEvent> stored = changes.removals.contains(it.key())
+            ? QList<StoredEvent>() : index.events.value(it.key());
+        QList<QPair<QString, QByteArray>> appended;
+        for (const QJsonValue& value : it.value()) {
+            QJsonObject event = value.toObject();
+            QString id = trackingEventId(event);
+            bool known = std::any_of(stored.cbegin(), stored.cend(),
+                [&id](const StoredEvent& e) { return e.id == id; });
+            if (!known) appended.append({ id, ResultCodec::encodeEvent(event) });
+        }
+        if (appended.isEmpty()) continue;
+
+        qint64 start = payloadStart();
+        QList<StoredEvent>& located = events[it.key()];
+        appendEntry(batch, makePayload(JournalEvents, [&](QDataStream& out) {
+            out << it.key() << static_cast<quint32>(appended.size());
+            for (const auto& event : appended) {
+                out << event.first;
+                qint64 offset = writeBytes(out, event.second);
+                located.append({ event.first, Location{ liveSource, start + offset,
+                    static_cast<qint32>(event.second.size()) } });
+            }
+        }));
+    }
+
+    if (journal.write(batch) != batch.size() || !journal.flush()) {
+        qDebug() << "Failed to append to package journal:" << journal.errorString();
+        // Cut off a partial write so later appends aren't stranded behind it
+        journal.resize(base);
+        journal.seek(base);
+        return false;
+    }
+
+    for (const QString& trackingNumber : changes.removals) {
+        index.results.remove(trackingNumber);
+        index.events.remove(trackingNumber);
+    }
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        index.results.insert(it.key(), it.value());
+    }
+    for (auto it = events.constBegin(); it != events.constEnd(); ++it) {
+        index.events[it.key()].append(it.value());
+    }
+
+    compactIfNeeded();
+    return true;
+}
+
+void JournalPackageStore::readEvents(QDataStream& in, int source, qint64 base, QList<StoredEvent>& events)
+{
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        StoredEvent event;
+        in >> event.id;
+        event.data.source = source;
+        event.data.offset = base + skipBytes(in, event.data.size);
+        events.append(event);
+    }
+}
+
+bool JournalPackageStore::readState(State& state)
+{
+    compaction.waitForFinished();
+
+    if (!readSnapshot(snapshotPath, state)) return false;
+    replayJournal(compactingPath, &state);
+    replayJournal(journalPath, &state);
+    return true;
+}
+
+void JournalPackageStore::adoptIndex(State& state)
+{
+    // Records are handed to the caller; only locations are kept
+    state.records.clear();
+    index = std::move(state);
+    liveSource = index.addSource(journalPath, false);
+}
+
+void JournalPackageStore::compactIfNeeded()
+{
+    // Once a compaction has landed, re-point the index at the new snapshot
+    // so the files it replaced can be closed
+    if (compactionPending && compaction.isFinished()) {
+        compactionPending = false;
+        State state;
+        if (compaction.result() && readState(state)) adoptIndex(state);
+    }
+
+    if (compaction.isRunning() || QFile::exists(compactingPath)) return;
+
+    qint64 snapshotSize = QFileInfo(snapshotPath).size();
+    if (journal.size() < qMax(JOURNAL_COMPACT_MIN_BYTES, snapshotSize)) return;
+
+    // Rotate the journal: new appends go to a fresh file while the old one
+    // is folded into the snapshot in the background. Offsets already taken
+    // into the old file stay valid through the handle the index holds.
+    journal.close();
+    if (!QFile::rename(journalPath, compactingPath)) {
+        qDebug() << "Failed to rotate package journal for compaction";
+    }
+    journal.setFileName(journalPath);
+    if (!journal.open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to reopen package journal:" << journal.errorString();
+        return;
+    }
+    journal.seek(journal.size());
+
+    if (QFile::exists(compactingPath)) {
+        liveSource = index.addSource(journalPath, false);
+        compaction = QtConcurrent::run(&JournalPackageStore::compact, snapshotPath, compactingPath);
+        compactionPending = true;
+    }
+}
+
+bool JournalPackageStore::compact(const QString& snapshotPath, const QString& journalPath)
+{
+    // Folding the journal into a partial state would drop everything the
+    // snapshot holds; leave both files alone and try again on the next open
+    State state;
+    if (!readSnapshot(snapshotPath, state)) return false;
+    replayJournal(journalPath, &state);
+
+    // Replaying is idempotent, so a crash between these two steps is harmless
+    if (!writeSnapshot(snapshotPath, state)) return false;
+    QFile::remove(journalPath);
+    return true;
+}
+
+bool JournalPackageStore::readSnapshot(const QString& path, State& state)
+{
+    if (!QFile::exists(path) || QFileInfo(path).size() == 0) return true;
+    int source = state.addSource(path, true);
+    if (source < 0) {
+        qDebug() << "Failed to open package snapshot:" << path;
+        return false;
+    }
+
+    const Source& snapshot = *state.sources.at(source);
+    QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(snapshot.mapped), snapshot.file.size());
+    QDataStream in(raw);
+    in.setVersion(STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != SNAPSHOT_MAGIC || version == 0 || version > SNAPSHOT_VERSION) {
+        qDebug() << "Unsupported package snapshot format";
+        return false;
+    }
+
+    quint32 recordCount = 0;
+    in >> recordCount;
+    state.records.reserve(recordCount);
+    for (quint32 i = 0; i < recordCount && in.status() == QDataStream::Ok; ++i) {
+        PackageRecord record = readRecord(in);
+        in >> record.locations;
+        state.records.insert(record.trackingNumber, record);
+    }
+
+    quint32 resultCount = 0;
+    in >> resultCount;
+    state.results.reserve(resultCount);
+    for (quint32 i = 0; i < resultCount && in.status() == QDataStream::Ok; ++i) {
+        QString trackingNumber;
+        Location location;
+        in >> trackingNumber;
+        location.source = source;
+        location.offset = skipBytes(in, location.size);
+        state.results.insert(trackingNumber, location);
+    }
+
+    if (version >= 2) {
+        quint32 historyCount = 0;
+        in >> historyCount;
+        for (quint32 i = 0; i < historyCount && in.status() == QDataStream::Ok; ++i) {
+            QString trackingNumber;
+            in >> trackingNumber;
+            readEvents(in, source, 0, state.events[trackingNumber]);
+        }
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+
+bool JournalPackageStore::writeSnapshot(const QString& path, const State& state)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to write package snapshot:" << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+    out << SNAPSHOT_MAGIC << SNAPSHOT_VERSION;
+
+    out << static_cast<quint32>(state.records.size());
+    for (const auto& record : state.records) {
+        writeRecord(out, record);
+        out << record.locations;
+    }
+
+    // Results and events are copied straight from the mapped sources
+    out << static_cast<quint32>(state.results.size());
+    for (auto it = state.results.constBegin(); it != state.results.constEnd(); ++it) {
+        out << it.key() << state.read(it.value());
+    }
+
+    out << static_cast<quint32>(state.events.size());
+    for (auto it = state.events.constBegin(); it != state.events.constEnd(); ++it) {
+        out << it.key() << static_cast<quint32>(it.value().size());
+        for (const StoredEvent& event : it.value()) {
+            out << event.id << state.read(event.data);
+        }
+    }
+
+    return file.commit();
+}
+
+qint64 JournalPackageStore::replayJournal(const QString& path, State* state)
+{
+    if (!QFile::exists(path) || QFileInfo(path).size() == 0) return 0;
+
+    // Only the valid length is wanted without a state; map a throwaway copy
+    State scratch;
+    State& target = state ? *state : scratch;
+    int source = target.addSource(path, true);
+    if (source < 0) return 0;
+
+    const Source& journalFile = *target.sources.at(source);
+    const char* data = reinterpret_cast<const char*>(journalFile.mapped);
+    const qint64 size = journalFile.file.size();
+    qint64 pos = 0;
+    while (pos + JOURNAL_HEADER_SIZE <= size) {
+        quint32 payloadSize = qFromBigEndian<quint32>(data + pos);
+        quint16 checksum = qFromBigEndian<quint16>(data + pos + 4);
+        if (pos + JOURNAL_HEADER_SIZE + payloadSize > size) break;
+
+        const qint64 payloadStart = pos + JOURNAL_HEADER_SIZE;
+        QByteArray payload = QByteArray::fromRawData(data + payloadStart, payloadSize);
+        if (qChecksum(payload) != checksum) break;
+
+        if (state) {
+            QDataStream in(payload);
+            in.setVersion(STREAM_VERSION);
+            quint8 op = 0;
+            in >> op;
+            if (op == JournalUpsert) {
+                // Upserts carry the record's own fields; its locations are journaled apart
+                PackageRecord record = readRecord(in);
+                record.locations = state->records.value(record.trackingNumber).locations;
+                state->records.insert(record.trackingNumber, record);
+            } else if (op == JournalRemove) {
+                QString trackingNumber;
+                in >> trackingNumber;
+                state->records.remove(trackingNumber);
+                state->results.remove(trackingNumber);
+                state->events.remove(trackingNumber);
+            } else if (op == JournalResult) {
+                QString trackingNumber;
+                Location location;
+                in >> trackingNumber;
+                location.source = source;
+                location.offset = payloadStart + skipBytes(in, location.size);
+                state->results.insert(trackingNumber, location);
+            } else if (op == JournalLocations) {
+                QString trackingNumber;
+                QStringList locations;
+                in >> trackingNumber >> locations;
+                auto record = state->records.find(trackingNumber);
+                if (record != state->records.end()) record->locations = locations;
+            } else if (op == JournalEvents) {
+                QString trackingNumber;
+                in >> trackingNumber;
+                readEvents(in, source, payloadStart, state->events[trackingNumber]);
+            }
+        }
+
+        pos += JOURNAL_HEADER_SIZE + payloadSize;
+    }
+
+    return pos;
+}
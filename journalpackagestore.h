@@ -0,0 +1,90 @@
+#ifndef JOURNALPACKAGESTORE_H
+#define JOURNALPACKAGESTORE_H
+
+#include <QFile>
+#include <QFuture>
+#include <QDataStream>
+#include <memory>
+#include "packagestore.h"
+
+constexpr qint64 JOURNAL_COMPACT_MIN_BYTES = 1024 * 1024; // don't compact journals under 1 MB
+
+// Lightweight alternative to the SQLite store. All packages live in a
+// compact binary snapshot that is memory-mapped at load time; every
+// mutation is one small record appended to a journal. Loading is a
+// snapshot read plus a journal replay, and once the journal outgrows the
+// snapshot it is folded into a new snapshot on a background thread.
+// Cached results and events stay on disk: the store only remembers where
+// each one sits in the mapped snapshot or journal, and reads and decodes it
+// when requested. New tracking events are journaled individually rather
+// than with the result.
+class JournalPackageStore : public PackageStore
+{
+public:
+    explicit JournalPackageStore(const QString& directory);
+    ~JournalPackageStore() override;
+
+    bool open() override;
+    bool openReadOnly() override;
+    bool isEmpty() override;
+    QList<PackageRecord> loadPackages() override;
+    QJsonObject loadResult(const QString& trackingNumber) override;
+    QSet<QString> loadEventIds(const QString& trackingNumber) override;
+    bool apply(const PackageChangeSet& changes) override;
+
+private:
+    // A snapshot or journal file, kept open while offsets into it are held
+    // so they stay readable after compaction renames or replaces the file
+    struct Source {
+        QFile file;
+        uchar* mapped = nullptr;
+
+        ~Source();
+        QByteArray read(qint64 offset, qint32 size);
+    };
+
+    // Where a ResultCodec-encoded result or event sits in one of the sources
+    struct Location {
+        int source = -1;
+        qint64 offset = 0;
+        qint32 size = 0;
+    };
+
+    struct StoredEvent {
+        QString id;
+        Location data;
+    };
+
+    struct State {
+        QHash<QString, PackageRecord> records;
+        QHash<QString, Location> results;
+        QHash<QString, QList<StoredEvent>> events;
+        QList<std::shared_ptr<Source>> sources;
+
+        int addSource(const QString& path, bool map);
+        QByteArray read(const Location& location) const;
+    };
+
+    static bool readSnapshot(const QString& path, State& state);
+    static bool writeSnapshot(const QString& path, const State& state);
+    static qint64 replayJournal(const QString& path, State* state);
+    static void readEvents(QDataStream& in, int source, qint64 base, QList<StoredEvent>& events);
+    static bool compact(const QString& snapshotPath, const QString& journalPath);
+
+    bool readState(State& state);
+    void adoptIndex(State& state);
+    void compactIfNeeded();
+
+    QString snapshotPath;
+    QString journalPath;
+    QString compactingPath;
+    QFile journal;
+    QFuture<bool> compaction;
+    bool compactionPending = false;
+    bool readOnly = false;
+    QList<PackageRecord> openedRecords; // read when opened, handed out by the first loadPackages()
+    State index;         // locations only; records are handed out, not kept
+    int liveSource = -1; // unmapped handle on the journal being appended to
+};
+
+#endif // JOURNALPACKAGESTORE_H
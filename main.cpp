@@ -1,15 +1,33 @@
 #include <QApplication>
 #include "mainwindow.h"
+#include "benchmark.h"
+#include "querycli.h"
+#include "startuptimeline.h"
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline::start();
     QApplication app(argc, argv);
+    StartupTimeline::mark("application created");
     
     // Set application info
     app.setApplicationName("Package Tracker");
     app.setApplicationVersion("1.0");
     app.setOrganizationName("MyCompany");
     
+    // Developer benchmarks: PackageTracker --benchmark <name> [count]
+    QStringList args = app.arguments();
+    int benchmarkIndex = args.indexOf("--benchmark");
+    if (benchmarkIndex >= 0) {
+        return runBenchmark(args.value(benchmarkIndex + 1), args.value(benchmarkIndex + 2).toInt());
+    }
+    
+    // Headless listing: PackageTracker --query '<filter expression>'
+    int queryIndex = args.indexOf("--query");
+    if (queryIndex >= 0) {
+        return runQueryCommand(args.value(queryIndex + 1));
+    }
+    
     MainWindow* mainWindow = new MainWindow();
     mainWindow->show();
     
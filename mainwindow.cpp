@@ -23,13 +23,46 @@
 #include <QGraphicsDropShadowEffect>
 #include <QToolButton>
 #include <QCheckBox>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QStandardPaths>
+#include <QDir>
+#include <QDataStream>
+#include <algorithm>
+#include <iterator>
+#include <QFileDialog>
+#include <QtConcurrent>
 #include "archivedpackageswindow.h"
+#include "resultcodec.h"
+#include "startuptimeline.h"
 
 #define REFRESH_INTERVAL 900000 // 15 minutes
 #define RETRY_DELAY 30000       // 30 seconds
 
 // Implementation of FrostedGlassEffect
 void FrostedGlassEffect::draw(QPainter* painter)
+{
+    // The blur is only rebuilt when the source or the surface it lands on changes
+    QPaintDevice* device = painter->device();
+    QRectF source = sourceBoundingRect(Qt::LogicalCoordinates);
+    QSize deviceSize(device->width(), device->height());
+    qreal ratio = device->devicePixelRatioF();
+    if (blurred.isNull() || source != blurredSource || deviceSize != blurredDeviceSize
+        || blurred.devicePixelRatio() != ratio) {
+        blurred = renderBlurred(deviceSize, ratio);
+        blurredSource = source;
+        blurredDeviceSize = deviceSize;
+    }
+    painter->drawPixmap(0, 0, blurred);
+}
+
+void FrostedGlassEffect::sourceChanged(ChangeFlags flags)
+{
+    Q_UNUSED(flags);
+    blurred = QPixmap();
+}
+
+QPixmap FrostedGlassEffect::renderBlurred(const QSize& deviceSize, qreal devicePixelRatio)
 {
     QPoint offset;
     QPixmap pixmap = sourcePixmap(Qt::LogicalCoordinates, &offset, QGraphicsEffect::PadToEffectiveBoundingRect);
@@ -44,89 +77,25 @@ void FrostedGlassEffect::draw(QPainter* painter)
     tempPainter.fillRect(temp.rect(), QColor(255, 255, 255, 180));
     tempPainter.end();
     
-    auto blur = std::make_unique<QGraphicsBlurEffect>();
+    // The item takes ownership of the blur effect
+    auto blur = new QGraphicsBlurEffect;
     blur->setBlurRadius(10);
     
     QGraphicsScene scene;
     QGraphicsPixmapItem item;
     item.setPixmap(QPixmap::fromImage(temp));
-    item.setGraphicsEffect(blur.get());
+    item.setGraphicsEffect(blur);
     scene.addItem(&item);
     
-    scene.render(painter, QRectF(), QRectF(-offset.x(), -offset.y(), pixmap.width(), pixmap.height()));
-}
-
-// Implementation of PackageItemDelegate
-PackageItemDelegate::PackageItemDelegate(QObject* parent) : QStyledItemDelegate(parent) {}
-
-void PackageItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
-{
-    QStyleOptionViewItem opt = option;
-    initStyleOption(&opt, index);
-    
-    QString status = index.data(Qt::UserRole).toString().toUpper();
-    QString note = index.data(Qt::UserRole + 1).toString();
-    
-    // Draw background
-    QStyle* style = opt.widget ? opt.widget->style() : QApplication::style();
-    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
-    
-    // Calculate positions
-    QRect rect = opt.rect;
-    int padding = 4;
-    
-    // Status color mapping
-    QColor statusColor = QColor("#95a5a6"); // Default gray
-    QString normalizedStatus = status.toUpper();
-    if (index.data(Qt::DisplayRole).toString().startsWith("SHIPPO_")) {
-        normalizedStatus = index.data(Qt::DisplayRole).toString().split("_")[1];
-    }
-    
-    if (normalizedStatus == "DELIVERED") statusColor = QColor("#27ae60");
-    else if (normalizedStatus == "TRANSIT") statusColor = QColor("#f39c12");
-    else if (normalizedStatus == "PRE_TRANSIT") statusColor = QColor("#3498db");
-    else if (normalizedStatus == "FAILURE") statusColor = QColor("#e74c3c");
-    else if (normalizedStatus == "RETURNED") statusColor = QColor("#9b59b6");
-    
-    // Draw status indicator
-    QRect iconRect = rect;
-    iconRect.setWidth(16);
-    iconRect.setHeight(16);
-    iconRect.moveTop(rect.top() + (rect.height() - iconRect.height()) / 2);
-    iconRect.moveLeft(rect.left() + padding);
-    
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing);
-    painter->setPen(Qt::NoPen);
-    painter->setBrush(statusColor);
-    painter->drawEllipse(iconRect);
-    painter->restore();
-    
-    // Draw tracking number
-    QRect textRect = rect;
-    textRect.setLeft(iconRect.right() + padding * 2);
-    QString trackingNumber = index.data(Qt::DisplayRole).toString();
-    painter->drawText(textRect, Qt::AlignVCenter, trackingNumber);
-    
-    // Draw note if present
-    if (!note.isEmpty()) {
-        QFont italicFont = painter->font();
-        italicFont.setItalic(true);
-        painter->save();
-        painter->setFont(italicFont);
-        painter->setPen(QColor("#666666"));
-        QRect noteRect = rect;
-        noteRect.setLeft(textRect.left() + painter->fontMetrics().horizontalAdvance(trackingNumber) + padding * 4);
-        painter->drawText(noteRect, Qt::AlignVCenter, "- " + note);
-        painter->restore();
-    }
-}
-
-QSize PackageItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
-{
-    QSize size = QStyledItemDelegate::sizeHint(option, index);
-    size.setHeight(size.height() + 8);
-    return size;
+    // Rendered over the whole device, as drawing straight to the painter did
+    QImage result(deviceSize * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    result.setDevicePixelRatio(devicePixelRatio);
+    result.fill(0);
+    QPainter resultPainter(&result);
+    scene.render(&resultPainter, QRectF(QPointF(0, 0), QSizeF(deviceSize)),
+        QRectF(-offset.x(), -offset.y(), pixmap.width(), pixmap.height()));
+    resultPainter.end();
+    return QPixmap::fromImage(std::move(result));
 }
 
 // MainWindow implementation
@@ -139,29 +108,60 @@ MainWindow::MainWindow(QWidget *parent)
     container = std::make_unique<QWidget>(this);
     container->setObjectName("container");
     
+    // Stage 1: only what the first frame needs, i.e. the window and the cached package list
     initializeTimers();
     setupUI();
+    StartupTimeline::mark("window built");
+    
+    initializeStorage();
+    loadPackages();
+    StartupTimeline::mark("cached packages loaded");
+    
+    bool darkMode = settings.value("darkMode", false).toBool();
+    applyTheme(darkMode);
+    
+    // Everything else waits for the first paint (see eventFilter)
+    container->installEventFilter(this);
+}
+
+bool MainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == container.get() && event->type() == QEvent::Paint) {
+        container->removeEventFilter(this);
+        StartupTimeline::mark("first paint");
+        QTimer::singleShot(0, this, &MainWindow::finishStartup);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::finishStartup()
+{
+    // Stage 2: tray icon, network client and background work
     setupTrayIcon();
     
     QString shippoToken = settings.value("shippoToken").toString();
-    if (!shippoToken.isEmpty()) {
+    if (!shippoToken.isEmpty() && !shippoClient) {
         shippoClient = std::make_unique<ShippoClient>(shippoToken, this);
         connectShippoSignals();
     }
+    StartupTimeline::finish();
     
-    loadPackages();
-    
-    bool darkMode = settings.value("darkMode", false).toBool();
-    applyTheme(darkMode);
-    
-    QTimer::singleShot(1000, this, &MainWindow::refreshPackages);
+    // Restored schedules mean only overdue packages are polled after a restart
+    QTimer::singleShot(1000, this, &MainWindow::pollDuePackages);
+    QTimer::singleShot(5000, this, &MainWindow::runArchivalPass);
 }
 
 void MainWindow::initializeTimers()
 {
+    // REFRESH_INTERVAL is the default poll interval; the scheduler stretches or
+    // shrinks it per package based on ETA and the last carrier scan.
+    pollScheduler = std::make_unique<PollScheduler>(REFRESH_INTERVAL);
+    pollScheduler->intervalModel().fromVariant(settings.value("scanIntervalModel").toMap());
+    pollScheduler->budget().setDailyBudget(settings.value("dailyRequestBudget", DEFAULT_DAILY_REQUEST_BUDGET).toInt());
+    
     refreshTimer = std::make_unique<QTimer>(this);
-    connect(refreshTimer.get(), &QTimer::timeout, this, &MainWindow::refreshPackages);
-    refreshTimer->start(REFRESH_INTERVAL);
+    connect(refreshTimer.get(), &QTimer::timeout, this, &MainWindow::pollDuePackages);
+    refreshTimer->start(SCHEDULER_TICK_INTERVAL);
     
     retryTimer = std::make_unique<QTimer>(this);
     connect(retryTimer.get(), &QTimer::timeout, this, &MainWindow::retryFailedUpdates);
@@ -169,7 +169,17 @@ void MainWindow::initializeTimers()
     
     queueProcessTimer = std::make_unique<QTimer>(this);
     connect(queueProcessTimer.get(), &QTimer::timeout, this, &MainWindow::processUpdateQueue);
-    queueProcessTimer->start(1000);
+    queueProcessTimer->start(QUEUE_PROCESS_INTERVAL);
+    
+    archivalTimer = std::make_unique<QTimer>(this);
+    archivalTimer->setTimerType(Qt::VeryCoarseTimer);
+    connect(archivalTimer.get(), &QTimer::timeout, this, &MainWindow::runArchivalPass);
+    archivalTimer->start(ARCHIVAL_CHECK_INTERVAL);
+    
+    scheduleSaveTimer = std::make_unique<QTimer>(this);
+    scheduleSaveTimer->setTimerType(Qt::VeryCoarseTimer);
+    connect(scheduleSaveTimer.get(), &QTimer::timeout, this, &MainWindow::saveSchedule);
+    scheduleSaveTimer->start(SCHEDULE_SAVE_INTERVAL);
 }
 
 void MainWindow::connectShippoSignals()
@@ -180,14 +190,46 @@ void MainWindow::connectShippoSignals()
         [this](const QJsonObject& info) {
             QString trackingNumber = info["tracking_number"].toString();
             
-            auto& package = packages[trackingNumber];
-            package.details = info;
+            // Ignore late responses for packages removed in the meantime
+            auto it = packages.find(trackingNumber);
+            if (it == packages.end()) return;
+            
+            auto& package = it.value();
+            PackageData previous = package;
             package.status = info["status"].toString();
+            package.carrier = info["carrier"].toString();
             package.retryCount = 0;
+            if (!PollScheduler::isTerminalStatus(package.status)) {
+                package.terminalSince = QDateTime();
+            } else if (!package.terminalSince.isValid()) {
+                package.terminalSince = QDateTime::currentDateTime();
+            }
+            recordPollResult(trackingNumber, info, QDateTime::currentDateTime());
+            
+            bool recordChanged = package.status != previous.status || package.carrier != previous.carrier
+                || package.terminalSince != previous.terminalSince;
+            if (recordChanged) {
+                markDirty(trackingNumber);
+            }
+            
+            // Only the normalized fields are cached. Most polls return exactly
+            // what we already have; skip the write and re-render then.
+            QJsonObject result = ResultCodec::normalized(info);
+            searchIndex.setField(trackingNumber, SearchIndex::CarrierField, package.carrier);
+            indexLocations(trackingNumber, result);
+            const QJsonObject* cached = detailsCache.object(trackingNumber);
+            if (cached && *cached == result) {
+                if (recordChanged) savePackages();
+                return;
+            }
+            
+            detailsCache.insert(trackingNumber, new QJsonObject(result));
+            dirtyResults.insert(trackingNumber, result);
+            savePackages();
             
             updatePackageStatus(trackingNumber, package.status);
             
-            if (packageList->currentItem() && packageList->currentItem()->text() == trackingNumber) {
+            if (!backgroundMode && currentTrackingNumber() == trackingNumber) {
                 showPackageDetails(trackingNumber);
             }
         });
@@ -206,6 +248,7 @@ void MainWindow::connectShippoSignals()
                     auto& package = it.value();
                     package.retryCount++;
                     package.lastUpdateAttempt = QDateTime::currentDateTime();
+                    pollScheduler->recordFailure(trackingNumber, package.lastUpdateAttempt);
                     
                     if (package.retryCount >= MAX_RETRY_ATTEMPTS) {
                         QMessageBox::warning(this, "Tracking Error", 
@@ -308,15 +351,25 @@ void MainWindow::setupInputArea()
 void MainWindow::setupSearchBar()
 {
     searchBar = std::make_unique<QLineEdit>(this);
-    searchBar->setPlaceholderText("Search packages by tracking number or note...");
-    connect(searchBar.get(), &QLineEdit::textChanged, this, &MainWindow::refreshPackageList);
+    searchBar->setPlaceholderText("Search, or filter like: status:TRANSIT carrier:ups eta<2d sort:eta");
+    
+    // Wait for a pause in typing rather than searching on every keystroke
+    searchDebounceTimer = std::make_unique<QTimer>(this);
+    searchDebounceTimer->setSingleShot(true);
+    searchDebounceTimer->setInterval(SEARCH_DEBOUNCE_INTERVAL);
+    connect(searchDebounceTimer.get(), &QTimer::timeout, this, &MainWindow::refreshPackageList);
+    connect(searchBar.get(), &QLineEdit::textChanged, searchDebounceTimer.get(), qOverload<>(&QTimer::start));
     
     containerLayout->addWidget(searchBar.get());
 }
 
 void MainWindow::setupPackageList()
 {
-    packageList = std::make_unique<QListWidget>(this);
+    // Only the rows on screen are laid out and painted
+    packageListModel = std::make_unique<PackageListModel>();
+    packageList = std::make_unique<QListView>(this);
+    packageList->setModel(packageListModel.get());
+    packageList->setUniformItemSizes(true);
     packageList->setSelectionMode(QAbstractItemView::SingleSelection);
     packageList->setContextMenuPolicy(Qt::CustomContextMenu);
     packageList->setItemDelegate(new PackageItemDelegate(packageList.get()));
@@ -363,6 +416,10 @@ void MainWindow::setupDetailsView()
 void MainWindow::setupMenuBar()
 {
     auto menuBar = std::make_unique<QMenuBar>(this);
+    QMenu* fileMenu = menuBar->addMenu("File");
+    fileMenu->addAction("Import Packages...", this, &MainWindow::importPackages);
+    fileMenu->addAction("Export Packages...", this, &MainWindow::exportPackages);
+
     auto settingsMenu = menuBar->addMenu("Settings");
     
     settingsMenu->addAction("API Credentials", this, [this]() {
@@ -382,7 +439,8 @@ void MainWindow::setupMenuBar()
     QMenu* viewMenu = menuBar->addMenu("View");
     viewMenu->addAction("Show Archived Packages", this, [this](){
         // Create and show the Archived Packages window (modal dialog)
-        auto archivedWindow = new ArchivedPackagesWindow(this);
+        auto archivedWindow = new ArchivedPackagesWindow(archiveModel.get(), this);
+        archivedWindow->setAttribute(Qt::WA_DeleteOnClose);
         connect(archivedWindow, &ArchivedPackagesWindow::requestUnarchive, this, &MainWindow::unarchivePackage);
         archivedWindow->exec();
     });
@@ -411,40 +469,41 @@ void MainWindow::setupConnections()
     connect(packageList.get(), &QWidget::customContextMenuRequested, this, [this](const QPoint &pos) {
         QMenu contextMenu(tr("Context menu"), this);
         
-        // Get the item at the context position
-        QListWidgetItem* item = packageList->itemAt(pos);
-        if (!item)
+        // Get the row at the context position
+        QModelIndex index = packageList->indexAt(pos);
+        if (!index.isValid())
             return;
+        packageList->setCurrentIndex(index);
         
         QAction *editNoteAction = contextMenu.addAction("Edit Note");
         connect(editNoteAction, &QAction::triggered, this, &MainWindow::editNote);
         
         // Add Archive/Unarchive action based on current state
-        bool isArchived = item->data(Qt::UserRole + 2).toBool();
+        bool isArchived = index.data(PackageListModel::ArchivedRole).toBool();
+        QString trackingNumber = index.data(PackageListModel::TrackingNumberRole).toString();
         QAction *archiveAction = contextMenu.addAction(isArchived ? "Unarchive" : "Archive");
-        connect(archiveAction, &QAction::triggered, this, [this, item]() {
-            // Extract the actual tracking number by removing the " [Archived]" suffix if present
-            QString trackingNumber = item->text();
-            const QString archivedSuffix = " [Archived]";
-            if (trackingNumber.endsWith(archivedSuffix)) {
-                trackingNumber = trackingNumber.left(trackingNumber.length() - archivedSuffix.length());
+        connect(archiveAction, &QAction::triggered, this, [this, trackingNumber, isArchived]() {
+            if (isArchived) {
+                unarchivePackage(trackingNumber);
+            } else {
+                // The list updates once the worker has moved it
+                archivePackages({ trackingNumber });
             }
-            
-            auto it = packages.find(trackingNumber);
-            if (it != packages.end()) {
-                // Toggle the archived status.
-                it.value().archived = !it.value().archived;
-            }
-            savePackages();
-            // Refresh the package list to immediately update the main window.
-            refreshPackageList();
         });
         
         contextMenu.exec(packageList->mapToGlobal(pos));
     });
     
-    connect(packageList.get(), &QListWidget::itemClicked, this, 
-        QOverload<QListWidgetItem*>::of(&MainWindow::showPackageDetails));
+    connect(packageList.get(), &QListView::clicked, this,
+        QOverload<const QModelIndex&>::of(&MainWindow::showPackageDetails));
+    
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, [this](Qt::ApplicationState state) {
+        if (state == Qt::ApplicationHidden || state == Qt::ApplicationSuspended) {
+            setBackgroundMode(true);
+        } else if (state == Qt::ApplicationActive && isVisible() && !isMinimized()) {
+            setBackgroundMode(false);
+        }
+    });
 }
 
 void MainWindow::setupTrayIcon()
@@ -484,30 +543,93 @@ void MainWindow::addPackage()
         return;
     }
     
-    auto item = std::make_unique<QListWidgetItem>(*validatedNumber);
-    item->setData(Qt::UserRole, "UNKNOWN");
-    item->setData(Qt::UserRole + 1, note);
-    
-    PackageData packageData("UNKNOWN", note);
-    packages[*validatedNumber] = packageData;
-    
-    packageList->insertItem(0, item.release());
+    if (packages.contains(*validatedNumber)) {
+        selectPackage(*validatedNumber);
+        QMessageBox::information(this, "Already Tracked", "This package is already being tracked.");
+        return;
+    }
     
     trackingInput->clear();
     noteInput->clear();
     
+    // An archived number is brought back rather than tracked a second time;
+    // the archive is checked on the worker so the GUI doesn't wait on it
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [this, worker, trackingNumber = *validatedNumber, note]() {
+        bool archived = worker->isArchived(trackingNumber);
+        QMetaObject::invokeMethod(this, [this, trackingNumber, note, archived]() {
+            if (packages.contains(trackingNumber)) return;
+            if (archived) {
+                unarchivePackage(trackingNumber);
+                if (!note.isEmpty() && packages.contains(trackingNumber)) {
+                    packages[trackingNumber].note = note;
+                    indexPackage(trackingNumber);
+                    packageListModel->setNote(trackingNumber, note);
+                    markDirty(trackingNumber);
+                    savePackages();
+                }
+                selectPackage(trackingNumber);
+                return;
+            }
+            trackNewPackage(trackingNumber, note);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::trackNewPackage(const QString& trackingNumber, const QString& note)
+{
+    PackageData packageData("UNKNOWN", note);
+    packages.insert(trackingNumber, packageData);
+    indexPackage(trackingNumber);
+    pollScheduler->track(trackingNumber, QDateTime::currentDateTime());
+    markDirty(trackingNumber);
+    
+    // A filtered or archived list decides for itself whether the package shows
+    if (packageList->model() != packageListModel.get() || (searchBar && !searchBar->text().isEmpty())) {
+        refreshPackageList();
+    } else {
+        PackageRow row;
+        row.trackingNumber = trackingNumber;
+        row.status = packageData.status;
+        row.note = note;
+        packageList->scrollTo(packageListModel->index(packageListModel->addPackage(row)));
+    }
+    
     savePackages();
-    scheduleUpdate(*validatedNumber);
+    scheduleUpdate(trackingNumber);
+}
+
+void MainWindow::selectPackage(const QString& trackingNumber)
+{
+    if (packageList->model() != packageListModel.get()) return;
+    int row = packageListModel->rowOf(trackingNumber);
+    if (row < 0) return;
+    QModelIndex index = packageListModel->index(row);
+    packageList->setCurrentIndex(index);
+    packageList->scrollTo(index);
 }
 
 void MainWindow::removePackage()
 {
-    auto item = packageList->currentItem();
-    if (!item) return;
-    
-    QString trackingNumber = item->text();
-    packages.remove(trackingNumber);
-    delete packageList->takeItem(packageList->row(item));
+    QString trackingNumber = currentTrackingNumber();
+    if (trackingNumber.isEmpty()) return;
+    
+    if (isArchivedInView(trackingNumber)) {
+        archivedInView.remove(trackingNumber);
+        PersistenceWorker* worker = persistenceWorker.get();
+        QMetaObject::invokeMethod(worker, [worker, trackingNumber]() {
+            worker->removeFromArchive({ trackingNumber });
+        }, Qt::QueuedConnection);
+        archiveModel->removePackages({ trackingNumber });
+        detailsCache.remove(trackingNumber);
+    } else {
+        packages.remove(trackingNumber);
+        archivingPackages.remove(trackingNumber);
+        searchIndex.removeDocument(trackingNumber);
+        pollScheduler->untrack(trackingNumber);
+        markRemoved(trackingNumber);
+    }
+    packageListModel->removePackage(trackingNumber);
     savePackages();
 }
 
@@ -520,52 +642,58 @@ void MainWindow::refreshPackages()
     }
 }
 
-void MainWindow::updatePackageStatus(const QString& trackingNumber, const QString& status)
+void MainWindow::pollDuePackages()
 {
-    for (int i = 0; i < packageList->count(); ++i) {
-        auto item = packageList->item(i);
-        if (item->text() == trackingNumber) {
-            QString oldStatus = item->data(Qt::UserRole).toString();
-            
-            if (oldStatus != status) {
-                item->setData(Qt::UserRole, status);
-                packageList->update(packageList->indexFromItem(item));
-                
-                QString notificationMsg = QString("Package %1 status changed from %2 to %3")
-                    .arg(trackingNumber)
-                    .arg(oldStatus)
-                    .arg(status);
-                showNotification("Package Status Update", notificationMsg);
-            }
-            break;
-        }
+    if (!shippoClient) return;
+    
+    QDateTime now = QDateTime::currentDateTime();
+    pollScheduler->replanBudgetIfNeeded(now);
+    for (const auto& trackingNumber : pollScheduler->duePackages(now)) {
+        scheduleUpdate(trackingNumber);
     }
 }
 
-void MainWindow::showPackageDetails(QListWidgetItem* item)
+void MainWindow::updatePackageStatus(const QString& trackingNumber, const QString& status)
+{
+    const PackageRow* row = packageListModel->rowAt(packageListModel->rowOf(trackingNumber));
+    if (!row || row->status == status) return;
+    
+    QString oldStatus = row->status;
+    packageListModel->setStatus(trackingNumber, status);
+    
+    QString notificationMsg = QString("Package %1 status changed from %2 to %3")
+        .arg(trackingNumber)
+        .arg(oldStatus)
+        .arg(status);
+    showNotification("Package Status Update", notificationMsg);
+}
+
+QString MainWindow::currentTrackingNumber() const
+{
+    return packageList->currentIndex().data(PackageListModel::TrackingNumberRole).toString();
+}
+
+void MainWindow::showPackageDetails(const QModelIndex& index)
 {
-    if (!item) return;
-    showPackageDetails(item->text());
+    if (!index.isValid()) return;
+    showPackageDetails(index.data(PackageListModel::TrackingNumberRole).toString());
 }
 
 void MainWindow::showPackageDetails(const QString& trackingNumber)
 {
-    auto it = packages.find(trackingNumber);
-    if (it == packages.end()) return;
+    if (!packages.contains(trackingNumber) && !isArchivedInView(trackingNumber)) return;
     
-    const auto& package = it.value();
-    if (package.details.isEmpty()) {
+    const QJsonObject* details = detailsCache.object(trackingNumber);
+    if (!details) {
         detailsView->setHtml(QString("<div style='color: %1; font-family: -apple-system;'>Loading details for: %2</div>")
             .arg(settings.value("darkMode", false).toBool() ? "#ffffff" : "#2c3e50")
             .arg(trackingNumber));
         
-        if (shippoClient) {
-            scheduleUpdate(trackingNumber);
-        }
+        requestDetails(trackingNumber);
         return;
     }
     
-    QString carrier = package.details["carrier"].toString();
+    QString carrier = (*details)["carrier"].toString();
     if (carrier.isEmpty()) carrier = "Unknown Carrier";
     
     bool isDarkMode = settings.value("darkMode", false).toBool();
@@ -574,8 +702,7 @@ void MainWindow::showPackageDetails(const QString& trackingNumber)
     QString sectionBgColor = isDarkMode ? "#1e1e1e" : "#f8f9fa";
     QString borderColor = isDarkMode ? "rgba(255, 255, 255, 0.15)" : "rgba(0, 0, 0, 0.1)";
     
-    QString details = formatPackageDetails(package.details, bgColor, borderColor, textColor, sectionBgColor);
-    detailsView->setHtml(details);
+    detailsView->setHtml(formatPackageDetails(*details, bgColor, borderColor, textColor, sectionBgColor));
 }
 
 QString MainWindow::formatPackageDetails(const QJsonObject& info, const QString& bgColor,
@@ -678,7 +805,9 @@ void MainWindow::handleWebhookEvent(const QString& event, const QJsonObject& dat
     QString details = trackingStatus["status_details"].toString();
     
     updatePackageStatus(trackingNumber, status);
-    showPackageDetails(trackingNumber);
+    if (!backgroundMode) {
+        showPackageDetails(trackingNumber);
+    }
     
     QString notificationMsg = QString("Package %1: %2\n%3")
         .arg(trackingNumber)
@@ -689,11 +818,11 @@ void MainWindow::handleWebhookEvent(const QString& event, const QJsonObject& dat
 
 void MainWindow::editNote()
 {
-    auto currentItem = packageList->currentItem();
-    if (!currentItem) return;
+    QModelIndex current = packageList->currentIndex();
+    if (!current.isValid()) return;
     
-    QString trackingNumber = currentItem->text();
-    QString currentNote = currentItem->data(Qt::UserRole + 1).toString();
+    QString trackingNumber = current.data(PackageListModel::TrackingNumberRole).toString();
+    QString currentNote = current.data(PackageListModel::NoteRole).toString();
     
     bool ok;
     QString newNote = QInputDialog::getText(this, "Edit Note",
@@ -701,50 +830,615 @@ void MainWindow::editNote()
         QLineEdit::Normal, currentNote, &ok);
     
     if (ok) {
-        currentItem->setData(Qt::UserRole + 1, newNote);
+        packageListModel->setNote(trackingNumber, newNote);
         auto it = packages.find(trackingNumber);
         if (it != packages.end()) {
             it.value().note = newNote;
+            searchIndex.setField(trackingNumber, SearchIndex::NoteField, newNote);
+            markDirty(trackingNumber);
+            savePackages();
+        } else if (isArchivedInView(trackingNumber)) {
+            PersistenceWorker* worker = persistenceWorker.get();
+            QMetaObject::invokeMethod(worker, [worker, trackingNumber, newNote]() {
+                worker->setArchivedNote(trackingNumber, newNote);
+            }, Qt::QueuedConnection);
+            archiveModel->setNote(trackingNumber, newNote);
         }
-        savePackages();
     }
 }
 
-void MainWindow::savePackages()
+void MainWindow::initializeStorage()
 {
-    QStringList packageListKeys;
-    QMap<QString, QVariant> notes;
-    QMap<QString, QVariant> archivedMap;
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    
+    // "sqlite" (default) or "journal" for the lighter snapshot + journal format
+    auto factory = PersistenceWorker::storeFactory(dataDir, settings.value("storageBackend", "sqlite").toString());
+    
+    // The store lives on its own thread so writes never block the UI
+    persistenceThread = std::make_unique<QThread>();
+    persistenceThread->setObjectName("PackagePersistence");
+    persistenceWorker = std::make_unique<PersistenceWorker>(factory, dataDir + "/archive.pack",
+        dataDir + "/schedule.dat");
+    persistenceWorker->moveToThread(persistenceThread.get());
+    persistenceThread->start();
+    archiveModel = std::make_unique<ArchiveModel>(persistenceWorker.get());
+    
+    connect(persistenceWorker.get(), &PersistenceWorker::eventsAppended, this,
+        [this](const QString& trackingNumber, int count) {
+            // The details view already shows them; the tray is how hidden windows find out
+            if (backgroundMode) {
+                showNotification("Package Update", QString("Package %1: %2 new tracking event%3")
+                    .arg(trackingNumber).arg(count).arg(count == 1 ? "" : "s"));
+            }
+        });
     
-    for (auto it = packages.begin(); it != packages.end(); ++it) {
-        packageListKeys << it.key();
-        notes[it.key()] = it.value().note;
-        archivedMap[it.key()] = it.value().archived;
+    connect(persistenceWorker.get(), &PersistenceWorker::packagesArchived, this, &MainWindow::archiveFinished);
+    
+    bool opened = false;
+    QMetaObject::invokeMethod(persistenceWorker.get(), [this, &opened]() {
+        opened = persistenceWorker->open();
+    }, Qt::BlockingQueuedConnection);
+    
+    if (!opened) {
+        QMessageBox::warning(this, "Storage Error",
+            "Could not open the package database. Changes will not be saved.");
     }
     
-    settings.setValue("trackingNumbers", packageListKeys);
-    settings.setValue("packageNotes", notes);
-    settings.setValue("packageArchived", archivedMap);
-    settings.sync();
+    saveTimer = std::make_unique<QTimer>(this);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(PERSIST_DEBOUNCE_INTERVAL);
+    connect(saveTimer.get(), &QTimer::timeout, this, &MainWindow::flushPendingChanges);
+    
+    // The window isn't necessarily destroyed on quit, so flush on the way out
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &MainWindow::shutdownStorage);
 }
 
-void MainWindow::loadPackages()
+void MainWindow::shutdownStorage()
+{
+    if (!persistenceThread) return;
+    
+    // A running search or import may still be waiting on the archive
+    cancelSearch();
+    for (QFuture<QList<PackageRow>>& search : abandonedSearches) {
+        search.waitForFinished();
+    }
+    if (importWatcher) importWatcher->waitForFinished();
+    
+    // Let in-flight archive moves report back so edits held for them land in
+    // the right place
+    if (!archivingPackages.isEmpty()) {
+        QMetaObject::invokeMethod(persistenceWorker.get(), []() {}, Qt::BlockingQueuedConnection);
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+    
+    // Hand over anything still pending and wait for it to hit the disk
+    flushPendingChanges();
+    saveSchedule();
+    bool saved = false;
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [worker, &saved]() {
+        saved = worker->shutdown();
+    }, Qt::BlockingQueuedConnection);
+    if (!saved) {
+        QMessageBox::warning(this, "Save Failed",
+            "Some recent changes to your packages could not be written to disk and will be missing next time.");
+    }
+    
+    persistenceThread->quit();
+    persistenceThread->wait();
+    showListModel(packageListModel.get());
+    archiveModel.reset();
+    persistenceWorker.reset();
+    persistenceThread.reset();
+}
+
+void MainWindow::migrateLegacySettings()
 {
+    // Packages used to be stored as whole-list blobs in QSettings
+    if (!settings.contains("trackingNumbers")) return;
+    
     QStringList savedPackages = settings.value("trackingNumbers").toStringList();
     QMap<QString, QVariant> notes = settings.value("packageNotes").toMap();
     QMap<QString, QVariant> archivedMap = settings.value("packageArchived").toMap();
+    QMap<QString, QVariant> terminalSinceMap = settings.value("packageTerminalSince").toMap();
+    
+    PackageChangeSet changes;
+    for (const QString& trackingNumber : savedPackages) {
+        PackageRecord record;
+        record.trackingNumber = trackingNumber;
+        record.note = notes.value(trackingNumber).toString();
+        record.archived = archivedMap.value(trackingNumber).toBool();
+        record.terminalSince = terminalSinceMap.value(trackingNumber).toDateTime();
+        changes.upserts.append(record);
+    }
+    
+    bool imported = false;
+    QMetaObject::invokeMethod(persistenceWorker.get(), [this, &imported, &changes]() {
+        imported = persistenceWorker->importIfEmpty(changes);
+    }, Qt::BlockingQueuedConnection);
+    if (!imported) return;
+    
+    settings.remove("trackingNumbers");
+    settings.remove("packageNotes");
+    settings.remove("packageArchived");
+    settings.remove("packageTerminalSince");
+    settings.sync();
+}
+
+void MainWindow::markDirty(const QString& trackingNumber)
+{
+    removedPackages.remove(trackingNumber);
+    dirtyPackages.insert(trackingNumber);
+}
+
+void MainWindow::markRemoved(const QString& trackingNumber)
+{
+    dirtyPackages.remove(trackingNumber);
+    dirtyResults.remove(trackingNumber);
+    detailsCache.remove(trackingNumber);
+    removedPackages.insert(trackingNumber);
+}
+
+void MainWindow::requestDetails(const QString& trackingNumber)
+{
+    if (pendingDetailLoads.contains(trackingNumber)) return;
+    pendingDetailLoads.insert(trackingNumber);
+    
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [this, worker, trackingNumber]() {
+        QJsonObject details = worker->loadResult(trackingNumber);
+        QMetaObject::invokeMethod(this, [this, trackingNumber, details]() {
+            detailsLoaded(trackingNumber, details);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::detailsLoaded(const QString& trackingNumber, const QJsonObject& details)
+{
+    pendingDetailLoads.remove(trackingNumber);
+    if (!packages.contains(trackingNumber) && !isArchivedInView(trackingNumber)) return;
+    
+    if (details.isEmpty()) {
+        // Nothing cached yet; fetch it from the API
+        if (shippoClient) {
+            scheduleUpdate(trackingNumber);
+        }
+        return;
+    }
+    
+    detailsCache.insert(trackingNumber, new QJsonObject(details));
+    if (packages.contains(trackingNumber)) {
+        indexLocations(trackingNumber, details);
+    }
+    
+    if (!backgroundMode && currentTrackingNumber() == trackingNumber) {
+        showPackageDetails(trackingNumber);
+    }
+}
+
+void MainWindow::recordPollResult(const QString& trackingNumber, const QJsonObject& info, const QDateTime& now)
+{
+    if (!pollScheduler->needsEventSeed(trackingNumber)) {
+        pollScheduler->recordResult(trackingNumber, info, now);
+        return;
+    }
+    
+    // The first result of a session only reaches the interval model once the
+    // stored history has said where its scans left off. Unsaved and cached
+    // results are newer than (or the same as) the store's.
+    auto dirty = dirtyResults.constFind(trackingNumber);
+    const QJsonObject* cached = detailsCache.object(trackingNumber);
+    if (dirty != dirtyResults.cend() || cached) {
+        pollScheduler->seedEvents(trackingNumber, dirty != dirtyResults.cend() ? dirty.value() : *cached);
+        pollScheduler->recordResult(trackingNumber, info, now);
+        return;
+    }
+    
+    // Otherwise ask the worker without waiting on it
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [this, worker, trackingNumber, info, now]() {
+        QJsonObject stored = worker->loadResult(trackingNumber);
+        QMetaObject::invokeMethod(this, [this, trackingNumber, info, now, stored]() {
+            if (pollScheduler->needsEventSeed(trackingNumber)) pollScheduler->seedEvents(trackingNumber, stored);
+            pollScheduler->recordResult(trackingNumber, info, now);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+PackageRecord MainWindow::toRecord(const QString& trackingNumber, const PackageData& package) const
+{
+    PackageRecord record;
+    record.trackingNumber = trackingNumber;
+    record.note = package.note;
+    record.status = package.status;
+    record.carrier = package.carrier;
+    record.terminalSince = package.terminalSince;
+    return record;
+}
+
+void MainWindow::archivePackages(const QStringList& trackingNumbers)
+{
+    // Edits to these packages must reach the worker before they're moved
+    flushPendingChanges();
+    
+    // Packages stay active (but unpolled) until the worker reports the move
+    QList<PackageRecord> records;
+    for (const QString& trackingNumber : trackingNumbers) {
+        auto it = packages.constFind(trackingNumber);
+        if (it == packages.cend() || archivingPackages.contains(trackingNumber)) continue;
+        PackageRecord record = toRecord(trackingNumber, it.value());
+        records.append(record);
+        archivingPackages.insert(trackingNumber, record);
+        pollScheduler->untrack(trackingNumber);
+    }
+    if (records.isEmpty()) return;
+    
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [worker, records]() {
+        worker->archivePackages(records);
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::archiveFinished(const QStringList& trackingNumbers, bool archived)
+{
+    QList<PackageRecord> moved;
+    QStringList removedMeanwhile;
+    QDateTime now = QDateTime::currentDateTime();
+    for (const QString& trackingNumber : trackingNumbers) {
+        auto pending = archivingPackages.find(trackingNumber);
+        if (pending == archivingPackages.end()) {
+            // Removed by the user while the move was in flight
+            removedMeanwhile << trackingNumber;
+            continue;
+        }
+        PackageRecord record = pending.value();
+        archivingPackages.erase(pending);
+        
+        if (!archived) {
+            if (packages.contains(trackingNumber)) pollScheduler->track(trackingNumber, now);
+            continue;
+        }
+        
+        // A note edited while the move was in flight goes to the archived copy
+        auto it = packages.constFind(trackingNumber);
+        if (it != packages.cend() && it.value().note != record.note) {
+            record.note = it.value().note;
+            PersistenceWorker* worker = persistenceWorker.get();
+            QMetaObject::invokeMethod(worker, [worker, trackingNumber, note = record.note]() {
+                worker->setArchivedNote(trackingNumber, note);
+            }, Qt::QueuedConnection);
+        }
+        packages.remove(trackingNumber);
+        searchIndex.removeDocument(trackingNumber);
+        detailsCache.remove(trackingNumber);
+        dirtyPackages.remove(trackingNumber);
+        dirtyResults.remove(trackingNumber);
+        record.archived = true;
+        moved.append(record);
+    }
+    
+    if (archived && !removedMeanwhile.isEmpty()) {
+        PersistenceWorker* worker = persistenceWorker.get();
+        QMetaObject::invokeMethod(worker, [worker, removedMeanwhile]() {
+            worker->removeFromArchive(removedMeanwhile);
+        }, Qt::QueuedConnection);
+    }
+    
+    if (!archived) {
+        // Edits held back during the move can be written now
+        if (!dirtyPackages.isEmpty() || !dirtyResults.isEmpty()) savePackages();
+        QMessageBox::warning(this, "Archive Failed",
+            QString("Could not move %1 package%2 to the archive. They are still in your active list.")
+                .arg(trackingNumbers.size()).arg(trackingNumbers.size() == 1 ? "" : "s"));
+        return;
+    }
+    if (moved.isEmpty()) return;
+    
+    archiveModel->addPackages(moved);
+    refreshPackageList();
+}
+
+void MainWindow::importPackages()
+{
+    if (importCommitting || (importWatcher && importWatcher->isRunning())) return;
+
+    QString path = QFileDialog::getOpenFileName(this, "Import Packages", QString(),
+        "Package lists (*.csv *.jsonl *.ndjson);;All files (*)");
+    if (path.isEmpty()) return;
+
+    // Packages already tracked, active or archived, are reported as duplicates.
+    // The archived ones are looked up from the import thread, not from here.
+    QSet<QString> active(packages.keyBegin(), packages.keyEnd());
+    PersistenceWorker* worker = persistenceWorker.get();
+    auto import = [worker, path, active]() {
+        QStringList archived;
+        QMetaObject::invokeMethod(worker, [worker, &archived]() {
+            archived = worker->archivedTrackingNumbers();
+        }, Qt::BlockingQueuedConnection);
+        QSet<QString> existing = active;
+        for (const QString& trackingNumber : std::as_const(archived)) {
+            existing.insert(trackingNumber);
+        }
+        return PackageImporter::importFile(path, existing);
+    };
+
+    importWatcher = std::make_unique<QFutureWatcher<ImportSummary>>();
+    connect(importWatcher.get(), &QFutureWatcher<ImportSummary>::finished, this, &MainWindow::importFinished);
+    importWatcher->setFuture(QtConcurrent::run(import));
+}
+
+void MainWindow::importFinished()
+{
+    ImportSummary summary = importWatcher->result();
+    if (!summary.error.isEmpty()) {
+        QMessageBox::warning(this, "Import Failed", summary.error);
+        return;
+    }
+
+    if (summary.records.isEmpty()) {
+        importCommitted(summary, 0);
+        return;
+    }
+
+    // Removals queued here must reach the worker ahead of the import
+    flushPendingChanges();
+
+    // Packages only show up once they're on disk, so a failed write can't
+    // leave the list showing packages the next launch won't have
+    importCommitting = true;
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [this, worker, summary]() {
+        qsizetype stored = worker->importPackages(summary.records);
+        QMetaObject::invokeMethod(this, [this, summary, stored]() {
+            importCommitted(summary, stored);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::importCommitted(const ImportSummary& summary, qsizetype stored)
+{
+    importCommitting = false;
+
+    QDateTime now = QDateTime::currentDateTime();
+    QList<PackageRecord> archived;
+    for (qsizetype i = 0; i < stored; ++i) {
+        const PackageRecord& record = summary.records.at(i);
+        if (record.archived) {
+            archived.append(record);
+            continue;
+        }
+        PackageData packageData(record.status, record.note);
+        packageData.carrier = record.carrier;
+        packages.insert(record.trackingNumber, packageData);
+        indexPackage(record.trackingNumber);
+        pollScheduler->track(record.trackingNumber, now);
+    }
+
+    // One rebuild for the whole import rather than one per package
+    if (!archived.isEmpty()) archiveModel->addPackages(archived);
+    if (stored > 0) refreshPackageList();
+
+    if (stored < summary.records.size()) {
+        QMessageBox::warning(this, "Import Failed",
+            QString("Only %1 of %2 packages could be saved; the rest were not imported.")
+                .arg(stored).arg(summary.records.size()));
+        return;
+    }
+
+    QMessageBox::information(this, "Import Complete",
+        QString("Imported %1 packages.\n%2 duplicates and %3 invalid tracking numbers were skipped.")
+            .arg(stored).arg(summary.duplicates).arg(summary.invalid));
+}
+
+void MainWindow::exportPackages()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Packages", "packages.csv",
+        "CSV (*.csv);;JSON Lines (*.jsonl)");
+    if (path.isEmpty()) return;
+
+    QList<PackageRecord> records;
+    records.reserve(packages.size());
+    for (auto it = packages.constBegin(); it != packages.constEnd(); ++it) {
+        records.append(toRecord(it.key(), it.value()));
+    }
+
+    // Written on the persistence thread so the archive can be streamed out page by page
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [this, worker, path, records]() {
+        QString error;
+        bool exported = worker->exportPackages(path, records, &error);
+        QMetaObject::invokeMethod(this, [this, exported, error]() {
+            if (exported) {
+                QMessageBox::information(this, "Export Complete", "Packages were exported successfully.");
+            } else {
+                QMessageBox::warning(this, "Export Failed", error);
+            }
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+bool MainWindow::isArchivedInView(const QString& trackingNumber) const
+{
+    return archivedInView.contains(trackingNumber)
+        || (packageList->model() == archiveModel.get() && archiveModel->contains(trackingNumber));
+}
+
+void MainWindow::savePackages()
+{
+    // Coalesce bursts of edits into one write shortly after the first one
+    if (!saveTimer->isActive()) {
+        saveTimer->start();
+    }
+}
+
+void MainWindow::flushPendingChanges()
+{
+    saveTimer->stop();
+    if (dirtyPackages.isEmpty() && dirtyResults.isEmpty() && removedPackages.isEmpty()) return;
+    
+    PackageChangeSet changes;
+    
+    // Writes for packages on their way into the archive are held back; they'd
+    // put them back in the store. They're dropped if the move succeeds.
+    QSet<QString> heldPackages;
+    QHash<QString, QJsonObject> heldResults;
+    for (const QString& trackingNumber : std::as_const(dirtyPackages)) {
+        auto it = packages.constFind(trackingNumber);
+        if (it == packages.cend()) continue;
+        if (archivingPackages.contains(trackingNumber)) {
+            heldPackages.insert(trackingNumber);
+        } else {
+            changes.upserts.append(toRecord(trackingNumber, it.value()));
+        }
+    }
+    for (auto it = dirtyResults.cbegin(); it != dirtyResults.cend(); ++it) {
+        if (archivingPackages.contains(it.key())) {
+            heldResults.insert(it.key(), it.value());
+        } else if (packages.contains(it.key())) {
+            changes.results.insert(it.key(), it.value());
+        }
+    }
+    changes.removals = QStringList(removedPackages.cbegin(), removedPackages.cend());
+    dirtyPackages = heldPackages;
+    dirtyResults = heldResults;
+    removedPackages.clear();
+    if (changes.upserts.isEmpty() && changes.results.isEmpty() && changes.removals.isEmpty()) return;
+    
+    // The worker merges and retries failed writes, so the dirty sets can be cleared here
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [worker, changes]() {
+        worker->enqueue(changes);
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::loadPackages()
+{
+    migrateLegacySettings();
+    
+    // Only the index tier is loaded here; results are fetched when a package is selected
+    QList<PackageRecord> records;
+    QMetaObject::invokeMethod(persistenceWorker.get(), [this, &records]() {
+        records = persistenceWorker->loadPackages();
+    }, Qt::BlockingQueuedConnection);
 
     packages.clear(); // Clear any existing package data.
-    for (const QString& trackingNumber : savedPackages) {
-        bool isArchived = archivedMap.contains(trackingNumber) ? archivedMap[trackingNumber].toBool() : false;
-        PackageData packageData("UNKNOWN", notes[trackingNumber].toString());
-        packageData.archived = isArchived;
-        packages[trackingNumber] = packageData;
+    searchIndex.clear();
+    detailsCache.clear();
+    QDateTime now = QDateTime::currentDateTime();
+    QStringList legacyArchived;
+    for (const PackageRecord& record : records) {
+        PackageData packageData(record.status, record.note);
+        packageData.carrier = record.carrier;
+        packageData.terminalSince = record.terminalSince;
+        packages[record.trackingNumber] = packageData;
+        indexPackage(record.trackingNumber);
+        if (!record.locations.isEmpty()) {
+            searchIndex.setField(record.trackingNumber, SearchIndex::LocationsField, record.locations.join('\n'));
+        }
+        if (record.archived) {
+            legacyArchived << record.trackingNumber;
+        } else {
+            pollScheduler->track(record.trackingNumber, now);
+        }
     }
+    QByteArray schedule;
+    QMetaObject::invokeMethod(persistenceWorker.get(), [this, &schedule]() {
+        schedule = persistenceWorker->loadSchedule();
+    }, Qt::BlockingQueuedConnection);
+    restoreSchedule(schedule);
+    
+    // Stores written before the archive tier existed keep archived rows inline
+    archivePackages(legacyArchived);
     // Instead of adding items here, refresh the list according to the current toggle.
     refreshPackageList();
 }
 
+void MainWindow::indexPackage(const QString& trackingNumber)
+{
+    auto it = packages.constFind(trackingNumber);
+    if (it == packages.cend()) return;
+    searchIndex.setPackage(trackingNumber, it.value().note, it.value().carrier);
+}
+
+void MainWindow::indexLocations(const QString& trackingNumber, const QJsonObject& result)
+{
+    // A fresh result carries the whole history, so it replaces what was loaded
+    QStringList locations = trackingEventLocations(result["events"].toArray());
+    if (!locations.isEmpty()) {
+        searchIndex.setField(trackingNumber, SearchIndex::LocationsField, locations.join('\n'));
+    }
+}
+
+QByteArray MainWindow::scheduleSnapshot() const
+{
+    QByteArray snapshot;
+    QDataStream out(&snapshot, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << SCHEDULE_MAGIC << SCHEDULE_VERSION;
+    pollScheduler->saveState(out);
+    
+    // Retry backoff and polls that were queued but not yet sent
+    QHash<QString, int> retries;
+    for (auto it = packages.constBegin(); it != packages.constEnd(); ++it) {
+        if (it.value().retryCount > 0) retries.insert(it.key(), it.value().retryCount);
+    }
+    QStringList queued;
+    for (std::queue<QString> pending = updateQueue; !pending.empty(); pending.pop()) {
+        queued << pending.front();
+    }
+    out << retries << queued;
+    
+    // Saved with the schedule so a crash doesn't reset the day's spend
+    const BudgetPlanner& budget = pollScheduler->budget();
+    out << budget.spendDate() << static_cast<qint32>(budget.spentOn(budget.spendDate()));
+    return snapshot;
+}
+
+void MainWindow::restoreSchedule(const QByteArray& snapshot)
+{
+    if (snapshot.isEmpty()) return;
+    
+    QDataStream in(snapshot);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != SCHEDULE_MAGIC || version != SCHEDULE_VERSION || !pollScheduler->restoreState(in)) {
+        qDebug() << "Ignoring unreadable poll schedule; packages will be polled from scratch";
+        return;
+    }
+    
+    QHash<QString, int> retries;
+    QStringList queued;
+    in >> retries >> queued;
+    if (in.status() != QDataStream::Ok) return;
+    
+    for (auto it = retries.constBegin(); it != retries.constEnd(); ++it) {
+        auto package = packages.find(it.key());
+        if (package != packages.end()) package.value().retryCount = it.value();
+    }
+    for (const QString& trackingNumber : queued) {
+        scheduleUpdate(trackingNumber);
+    }
+    
+    QDate spendDate;
+    qint32 spent = 0;
+    in >> spendDate >> spent;
+    if (in.status() == QDataStream::Ok) pollScheduler->budget().restoreSpend(spendDate, spent);
+}
+
+void MainWindow::saveSchedule()
+{
+    if (!pollScheduler || !persistenceWorker) return;
+    
+    QByteArray snapshot = scheduleSnapshot();
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [worker, snapshot]() {
+        worker->saveSchedule(snapshot);
+    }, Qt::QueuedConnection);
+}
+
 void MainWindow::mousePressEvent(QMouseEvent* event)
 {
     if (event->button() == Qt::LeftButton) {
@@ -770,9 +1464,68 @@ void MainWindow::mouseReleaseEvent(QMouseEvent* event)
     }
 }
 
+void MainWindow::changeEvent(QEvent* event)
+{
+    if (event->type() == QEvent::WindowStateChange) {
+        setBackgroundMode(isMinimized() || !isVisible());
+    }
+    QMainWindow::changeEvent(event);
+}
+
+void MainWindow::showEvent(QShowEvent* event)
+{
+    QMainWindow::showEvent(event);
+    if (!isMinimized()) {
+        setBackgroundMode(false);
+    }
+}
+
+void MainWindow::hideEvent(QHideEvent* event)
+{
+    QMainWindow::hideEvent(event);
+    setBackgroundMode(true);
+}
+
+void MainWindow::setBackgroundMode(bool background)
+{
+    // Visibility events can arrive before the UI and timers exist
+    if (backgroundMode == background || !pollScheduler || !packageList) return;
+    backgroundMode = background;
+    
+    // Slow down and coalesce the timers while hidden; tray notifications keep working
+    Qt::TimerType timerType = background ? Qt::VeryCoarseTimer : Qt::CoarseTimer;
+    refreshTimer->setTimerType(timerType);
+    retryTimer->setTimerType(timerType);
+    queueProcessTimer->setTimerType(timerType);
+    
+    refreshTimer->start(background ? BACKGROUND_TICK_INTERVAL : SCHEDULER_TICK_INTERVAL);
+    retryTimer->start(background ? RETRY_DELAY * BACKGROUND_INTERVAL_SCALE : RETRY_DELAY);
+    queueProcessTimer->start(background ? BACKGROUND_QUEUE_INTERVAL : QUEUE_PROCESS_INTERVAL);
+    pollScheduler->setIntervalScale(background ? BACKGROUND_INTERVAL_SCALE : 1.0);
+    
+    // Stop the frameless window from repainting while nobody can see it
+    container->setUpdatesEnabled(!background);
+    
+    if (!background) {
+        // Catch up on everything that was deferred while hidden
+        if (listRefreshPending) {
+            listRefreshPending = false;
+            refreshPackageList();
+        }
+        showPackageDetails(packageList->currentIndex());
+        pollScheduler->catchUp(QDateTime::currentDateTime());
+        pollDuePackages();
+    }
+}
+
 MainWindow::~MainWindow()
 {
-    savePackages();
+    shutdownStorage();
+    
+    if (pollScheduler) {
+        settings.setValue("scanIntervalModel", pollScheduler->intervalModel().toVariant());
+        settings.sync();
+    }
     cleanupResources();
 }
 
@@ -781,45 +1534,31 @@ void MainWindow::cleanupResources()
     if (refreshTimer) refreshTimer->stop();
     if (retryTimer) retryTimer->stop();
     if (queueProcessTimer) queueProcessTimer->stop();
+    if (archivalTimer) archivalTimer->stop();
+    if (scheduleSaveTimer) scheduleSaveTimer->stop();
     
     while (!updateQueue.empty()) {
         updateQueue.pop();
     }
+    queuedUpdates.clear();
 }
 
 std::optional<QString> MainWindow::validateTrackingNumber(const QString& number) const
 {
-    if (number.isEmpty()) {
-        return std::nullopt;
-    }
-    
-    static const QStringList validTestNumbers = {
-        "SHIPPO_PRE_TRANSIT",
-        "SHIPPO_TRANSIT",
-        "SHIPPO_DELIVERED",
-        "SHIPPO_RETURNED",
-        "SHIPPO_FAILURE",
-        "SHIPPO_UNKNOWN"
-    };
-    
-    if (number.startsWith("SHIPPO_") && !validTestNumbers.contains(number)) {
-        return std::nullopt;
-    }
-    
-    return number;
+    return PackageImporter::validateTrackingNumber(number);
 }
 
 void MainWindow::scheduleUpdate(const QString& trackingNumber)
 {
-    auto it = packages.find(trackingNumber);
-    if (it != packages.end() && it.value().archived) {
-        // Skip scheduling API update for archived packages.
+    // Archived (and removed) packages aren't in the map and are never polled
+    if (!packages.contains(trackingNumber) || archivingPackages.contains(trackingNumber)) {
         return;
     }
     
-    if (!updateQueue.empty() && updateQueue.back() == trackingNumber) {
+    if (queuedUpdates.contains(trackingNumber)) {
         return;
     }
+    queuedUpdates.insert(trackingNumber);
     updateQueue.push(trackingNumber);
 }
 
@@ -873,17 +1612,17 @@ void MainWindow::applyTheme(bool darkMode)
     
     // Package list styling
     packageList->setStyleSheet(QString(
-        "QListWidget {"
+        "QListView {"
         "  background-color: %1;"
         "  color: %2;"
         "  border: 1px solid %3;"
         "  border-radius: 4px;"
         "}"
-        "QListWidget::item {"
+        "QListView::item {"
         "  padding: 8px;"
         "  border-bottom: 1px solid %3;"
         "}"
-        "QListWidget::item:selected {"
+        "QListView::item:selected {"
         "  background-color: #3498db;"
         "  color: white;"
         "}"
@@ -900,9 +1639,7 @@ void MainWindow::applyTheme(bool darkMode)
     ).arg(bgColor).arg(textColor).arg(borderColor));
     
     // If a package is currently selected, refresh its details to update colors
-    if (packageList->currentItem()) {
-        showPackageDetails(packageList->currentItem());
-    }
+    showPackageDetails(packageList->currentIndex());
 }
 
 void MainWindow::updateApiClients(const QString& shippoToken)
@@ -913,13 +1650,34 @@ void MainWindow::updateApiClients(const QString& shippoToken)
     shippoClient = std::make_unique<ShippoClient>(shippoToken, this);
     connectShippoSignals();
     
-    // Refresh all packages with new client
-    refreshPackages();
+    // Only packages that are due; a new token doesn't make every package stale
+    pollDuePackages();
+}
+
+void MainWindow::setDailyRequestBudget(int requestsPerDay)
+{
+    settings.setValue("dailyRequestBudget", requestsPerDay);
+    settings.sync();
+    
+    pollScheduler->budget().setDailyBudget(requestsPerDay);
+    pollScheduler->replanBudget(QDateTime::currentDateTime());
+}
+
+QString MainWindow::budgetSummary() const
+{
+    const BudgetPlanner& budget = pollScheduler->budget();
+    QString limit = budget.dailyBudget() > 0 ? QString::number(budget.dailyBudget()) : "unlimited";
+    return QString("Projected %1 requests/day, %2 used today (budget: %3)\n"
+                   "Scan timing has saved %4 polls so far")
+        .arg(qRound(budget.projectedPerDay()))
+        .arg(budget.spentOn(QDate::currentDate()))
+        .arg(limit)
+        .arg(qRound(pollScheduler->intervalModel().pollsSaved()));
 }
 
 void MainWindow::retryFailedUpdates()
 {
-    if (!shippoClient) return;
+    if (!shippoClient || pollScheduler->budget().isExhausted(QDate::currentDate())) return;
     
     for (auto it = packages.begin(); it != packages.end(); ++it) {
         auto& package = it.value();
@@ -935,6 +1693,11 @@ void MainWindow::processUpdateQueue()
         return;
     }
     
+    // Queued packages wait for the budget to reset rather than overspending it
+    if (pollScheduler->budget().isExhausted(QDate::currentDate())) {
+        return;
+    }
+    
     isProcessingQueue = true;
     QString trackingNumber = updateQueue.front();
     updateQueue.pop();
@@ -946,59 +1709,227 @@ void MainWindow::processUpdateQueue()
         if (package.lastUpdateAttempt.isValid() && 
             package.lastUpdateAttempt.secsTo(QDateTime::currentDateTime()) < RETRY_DELAY / 1000) {
             updateQueue.push(trackingNumber); // Re-queue for later
-        } else {
-            shippoClient->trackPackage(trackingNumber);
-            package.lastUpdateAttempt = QDateTime::currentDateTime();
+            isProcessingQueue = false;
+            return;
         }
+        
+        shippoClient->trackPackage(trackingNumber);
+        package.lastUpdateAttempt = QDateTime::currentDateTime();
+        pollScheduler->budget().recordRequest(package.lastUpdateAttempt.date());
+        pollScheduler->recordAttempt(trackingNumber, package.lastUpdateAttempt);
     }
+    queuedUpdates.remove(trackingNumber);
     
     isProcessingQueue = false;
 }
 
+void MainWindow::runArchivalPass()
+{
+    int archiveAfterDays = settings.value("autoArchiveDays", DEFAULT_AUTO_ARCHIVE_DAYS).toInt();
+    if (archiveAfterDays <= 0) return;
+    
+    QDateTime cutoff = QDateTime::currentDateTime().addDays(-archiveAfterDays);
+    QStringList batch;
+    for (auto it = packages.cbegin(); it != packages.cend() && batch.size() < ARCHIVAL_BATCH_SIZE; ++it) {
+        const auto& package = it.value();
+        if (package.terminalSince.isValid() && package.terminalSince <= cutoff
+            && !archivingPackages.contains(it.key())) {
+            batch << it.key();
+        }
+    }
+    if (batch.isEmpty()) return;
+    
+    // One move into the archive and one list update per batch
+    archivePackages(batch);
+    
+    // Yield to the event loop between batches
+    if (batch.size() == ARCHIVAL_BATCH_SIZE) {
+        QTimer::singleShot(0, this, &MainWindow::runArchivalPass);
+    }
+}
+
 void MainWindow::unarchivePackage(const QString& trackingNumber)
 {
-    auto it = packages.find(trackingNumber);
-    if (it != packages.end()) {
-        it.value().archived = false;
-        savePackages();
-        // Refresh the list so the unarchived package is removed when in "archived" view
-        refreshPackageList();
+    QList<ArchivedPackage> restored;
+    PersistenceWorker* worker = persistenceWorker.get();
+    QMetaObject::invokeMethod(worker, [worker, &restored, trackingNumber]() {
+        restored = worker->unarchivePackages({ trackingNumber });
+    }, Qt::BlockingQueuedConnection);
+    
+    QDateTime now = QDateTime::currentDateTime();
+    for (const ArchivedPackage& package : restored) {
+        const PackageRecord& record = package.record;
+        PackageData packageData(record.status, record.note);
+        packageData.carrier = record.carrier;
+        // Restart the auto-archive clock so it isn't archived again right away
+        packageData.terminalSince = record.terminalSince.isValid() ? now : QDateTime();
+        packages[record.trackingNumber] = packageData;
+        indexPackage(record.trackingNumber);
+        pollScheduler->track(record.trackingNumber, now);
+        pollScheduler->seedEvents(record.trackingNumber, package.result);
+        if (!package.result.isEmpty()) {
+            detailsCache.insert(record.trackingNumber, new QJsonObject(package.result));
+            indexLocations(record.trackingNumber, package.result);
+        }
+        markDirty(record.trackingNumber);
     }
+    if (restored.isEmpty()) return;
+    
+    archiveModel->removePackages({ trackingNumber });
+    savePackages();
+    // Refresh the list so the unarchived package is removed when in "archived" view
+    refreshPackageList();
 }
 
 void MainWindow::refreshPackageList()
 {
-    packageList->clear();
-    QString filterText;
+    if (backgroundMode) {
+        listRefreshPending = true;
+        return;
+    }
+    
     // If the search bar exists and has text, use it as our filter (converted to lowercase)
+    QString filterText;
     if (searchBar && !searchBar->text().isEmpty())
         filterText = searchBar->text().toLower();
     
-    // Loop through all packages
-    for (auto it = packages.begin(); it != packages.end(); ++it) {
-        QString trackingNumber = it.key();
-        QString note = it.value().note;
-        bool matchesFilter = true;
+    // When filtering, ignore the archived toggle; matches stream in from a
+    // background search
+    cancelSearch();
+    if (!filterText.isEmpty()) {
+        showListModel(packageListModel.get());
+        startSearch(filterText);
+        return;
+    }
+    
+    // Without a filter the archived view is the paged archive model itself,
+    // so the archive is only read a page at a time as the list scrolls
+    archivedInView.clear();
+    if (showArchived) {
+        showListModel(archiveModel.get());
+        return;
+    }
+    
+    QList<PackageRow> rows;
+    for (auto it = packages.cbegin(); it != packages.cend(); ++it) {
+        rows.append({ it.key(), it.value().status, it.value().note, false });
+    }
+    // Applied as a diff against what is already shown
+    showListModel(packageListModel.get());
+    packageListModel->updateRows(rows);
+}
+
+void MainWindow::showListModel(QAbstractItemModel* model)
+{
+    if (packageList->model() == model) return;
+    // The view doesn't delete the selection model it made for the old one
+    QItemSelectionModel* previousSelection = packageList->selectionModel();
+    packageList->setModel(model);
+    delete previousSelection;
+}
+
+void MainWindow::startSearch(const QString& filterText)
+{
+    // Parsed once here; the query runs against copies of the index, package
+    // map and poll states. They share their data with the live ones, so taking
+    // them is cheap, but a GUI edit while the search runs pays for a deep copy.
+    // The copies may fall behind; searchResultsReady() takes status and note
+    // from the live map.
+    PackageQuery query = PackageQuery::parse(filterText);
+    PersistenceWorker* worker = persistenceWorker.get();
+    auto search = [index = searchIndex, packages = packages, states = pollScheduler->pollStates(), worker, query](
+            QPromise<QList<PackageRow>>& promise) {
+        auto archive = [worker](const QString& filter) {
+            QList<PackageRecord> archived;
+            QMetaObject::invokeMethod(worker, [worker, &archived, filter]() {
+                archived = worker->queryArchive(filter);
+            }, Qt::BlockingQueuedConnection);
+            return archived;
+        };
         
-        if (!filterText.isEmpty()) {
-            // When filtering, ignore the archived toggle.
-            if (!trackingNumber.toLower().contains(filterText) && !note.toLower().contains(filterText))
-                matchesFilter = false;
-        } else {
-            // Without a search filter, show only packages that match the current toggle (archived or not)
-            if (it.value().archived != showArchived)
-                matchesFilter = false;
+        auto columnsOf = [&](const QString& trackingNumber) -> std::optional<PackageColumns> {
+            auto it = packages.constFind(trackingNumber);
+            if (it == packages.cend()) return std::nullopt;
+            PackageColumns columns;
+            columns.trackingNumber = trackingNumber;
+            columns.status = it.value().status;
+            columns.carrier = it.value().carrier;
+            columns.note = it.value().note;
+            auto state = states.constFind(trackingNumber);
+            if (state != states.cend()) {
+                columns.eta = state.value().estimatedDelivery;
+                columns.lastUpdate = state.value().lastSuccessfulPoll;
+            }
+            columns.text = index.textOf(trackingNumber);
+            return columns;
+        };
+        // Each tier is shown as soon as it's ready, most relevant first
+        query.stream(index, columnsOf, archive, [&promise](const QList<QueryMatch>& matches) {
+            QList<PackageRow> batch;
+            batch.reserve(matches.size());
+            for (const QueryMatch& match : matches) {
+                const PackageColumns& columns = match.columns;
+                batch.append({ columns.trackingNumber, columns.status, columns.note, columns.archived, match.rank });
+            }
+            promise.addResult(batch);
+        }, [&promise]() { return promise.isCanceled(); });
+    };
+    
+    searchRows.clear();
+    searchWatcher = std::make_unique<QFutureWatcher<QList<PackageRow>>>();
+    connect(searchWatcher.get(), &QFutureWatcher<QList<PackageRow>>::resultsReadyAt,
+        this, &MainWindow::searchResultsReady);
+    connect(searchWatcher.get(), &QFutureWatcher<QList<PackageRow>>::finished, this, [this]() {
+        // A search with no matches never delivers a batch
+        if (!searchWatcher->isCanceled() && searchRows.isEmpty()) {
+            archivedInView.clear();
+            packageListModel->updateRows(searchRows);
         }
+    });
+    searchWatcher->setFuture(QtConcurrent::run(search));
+}
+
+void MainWindow::searchResultsReady(int begin, int end)
+{
+    // The first batch replaces what was shown; later ones extend it
+    if (searchRows.isEmpty()) archivedInView.clear();
+    for (int i = begin; i < end; ++i) {
+        QList<PackageRow> batch;
+        for (PackageRow row : searchWatcher->resultAt(i)) {
+            if (row.archived) {
+                archivedInView.insert(row.trackingNumber);
+            } else {
+                // Edits made since the search started win over its copy
+                auto live = packages.constFind(row.trackingNumber);
+                if (live == packages.cend()) continue;
+                row.status = live.value().status;
+                row.note = live.value().note;
+            }
+            batch.append(row);
+        }
+        if (batch.isEmpty()) continue;
         
-        if (matchesFilter) {
-            auto item = std::make_unique<QListWidgetItem>(trackingNumber);
-            item->setData(Qt::UserRole, it.value().status);
-            item->setData(Qt::UserRole + 1, note);
-            item->setData(Qt::UserRole + 2, it.value().archived);
-            // If this package is archived, add a little indicator in the item text.
-            if (it.value().archived)
-                item->setText(trackingNumber + " [Archived]");
-            packageList->addItem(item.release());
+        // Active tiers follow one another; archived rows rank in between them
+        if (searchRows.isEmpty() || !PackageListModel::rowLess(batch.first(), searchRows.last())) {
+            searchRows.append(batch);
+        } else {
+            QList<PackageRow> merged;
+            merged.reserve(searchRows.size() + batch.size());
+            std::merge(searchRows.cbegin(), searchRows.cend(), batch.cbegin(), batch.cend(),
+                std::back_inserter(merged), PackageListModel::rowLess);
+            searchRows = std::move(merged);
         }
     }
+    packageListModel->updateRows(searchRows);
+}
+
+void MainWindow::cancelSearch()
+{
+    // Superseded searches stop at their next check; nothing waits for them here
+    abandonedSearches.removeIf([](const QFuture<QList<PackageRow>>& future) { return future.isFinished(); });
+    if (!searchWatcher) return;
+    searchWatcher->disconnect(this);
+    searchWatcher->cancel();
+    if (!searchWatcher->isFinished()) abandonedSearches.append(searchWatcher->future());
+    searchWatcher.reset();
 }
@@ -9,7 +9,11 @@
 #include <QSettings>
 #include <QTimer>
 #include <QMap>
+#include <QSet>
+#include <QThread>
+#include <QCache>
 #include <QPoint>
+#include <QFutureWatcher>
 
 // Qt JSON
 #include <QJsonObject>
@@ -25,7 +29,7 @@
 
 // Qt Widgets
 #include <QWidget>
-#include <QListWidget>
+#include <QListView>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QTextEdit>
@@ -49,6 +53,15 @@
 // Project headers
 #include "shippoclient.h"
 #include "settingsdialog.h"
+#include "pollscheduler.h"
+#include "packagestore.h"
+#include "persistenceworker.h"
+#include "archivemodel.h"
+#include "packagelistmodel.h"
+#include "packageitemdelegate.h"
+#include "searchindex.h"
+#include "packagequery.h"
+#include "packagetransfer.h"
 
 // Forward declarations
 class ShippoClient;
@@ -59,6 +72,29 @@ class PackageUpdateWorker;
 constexpr int REFRESH_INTERVAL = 5 * 60 * 1000; // 5 minutes
 constexpr int MAX_RETRY_ATTEMPTS = 3;
 constexpr int RETRY_DELAY = 5000; // 5 seconds
+constexpr int QUEUE_PROCESS_INTERVAL = 1000; // 1 second
+
+// Throttled rates while the window is hidden or minimized
+constexpr int BACKGROUND_TICK_INTERVAL = 5 * 60 * 1000; // 5 minutes
+constexpr int BACKGROUND_QUEUE_INTERVAL = 5000; // 5 seconds
+constexpr int BACKGROUND_INTERVAL_SCALE = 3;
+
+// Automatic archival of delivered/returned/failed packages
+constexpr int ARCHIVAL_CHECK_INTERVAL = 60 * 60 * 1000; // 1 hour
+constexpr int ARCHIVAL_BATCH_SIZE = 250;
+constexpr int DEFAULT_AUTO_ARCHIVE_DAYS = 7; // 0 = disabled
+
+// Edits are coalesced for this long before being handed to the persistence thread
+constexpr int PERSIST_DEBOUNCE_INTERVAL = 250;
+
+// Poll schedules are snapshotted this often (and at exit) for warm restarts
+constexpr int SCHEDULE_SAVE_INTERVAL = 15 * 60 * 1000; // 15 minutes
+
+// Search runs once typing pauses for this long; results reach the view a relevance tier at a time
+constexpr int SEARCH_DEBOUNCE_INTERVAL = 150;
+
+// Number of tracking results (with event histories) kept in memory
+constexpr int DETAILS_CACHE_SIZE = 200;
 
 class FrostedGlassEffect : public QGraphicsEffect
 {
@@ -67,14 +103,14 @@ public:
     FrostedGlassEffect(QObject* parent = nullptr) : QGraphicsEffect(parent) {}
 protected:
     void draw(QPainter* painter) override;
-};
+    void sourceChanged(ChangeFlags flags) override;
+private:
+    QPixmap renderBlurred(const QSize& deviceSize, qreal devicePixelRatio);
 
-class PackageItemDelegate : public QStyledItemDelegate {
-    Q_OBJECT
-public:
-    explicit PackageItemDelegate(QObject* parent = nullptr);
-    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
-    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    // Blurred output of the last rebuild and the geometry it was rendered for
+    QPixmap blurred;
+    QRectF blurredSource;
+    QSize blurredDeviceSize;
 };
 
 class MainWindow : public QMainWindow {
@@ -84,6 +120,8 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow() override;
     void updateApiClients(const QString& shippoToken);
+    void setDailyRequestBudget(int requestsPerDay);
+    QString budgetSummary() const;
     void applyTheme(bool darkMode);
     void unarchivePackage(const QString& trackingNumber);
     void refreshPackageList();
@@ -92,8 +130,9 @@ private slots:
     void addPackage();
     void removePackage();
     void refreshPackages();
+    void pollDuePackages();
     void editNote();
-    void showPackageDetails(QListWidgetItem* item);
+    void showPackageDetails(const QModelIndex& index);
     void showPackageDetails(const QString& trackingNumber);
     void setupTrayIcon();
     void updatePackageStatus(const QString& trackingNumber, const QString& status);
@@ -101,15 +140,21 @@ private slots:
     void retryFailedUpdates();
     void processUpdateQueue();
     void connectShippoSignals();
+    void runArchivalPass();
+    void finishStartup();
+    void importPackages();
+    void importFinished();
+    void importCommitted(const ImportSummary& summary, qsizetype stored);
+    void exportPackages();
 
 private:
     struct PackageData {
         QString status = "UNKNOWN";
         QString note;
-        QJsonObject details;
+        QString carrier;
         int retryCount = 0;
         QDateTime lastUpdateAttempt;
-        bool archived = false;
+        QDateTime terminalSince; // when the package reached a terminal status
         
         PackageData() = default;
         PackageData(const QString& s, const QString& n) 
@@ -126,10 +171,36 @@ private:
     void setupLayout();
     void setupConnections();
     void setupSearchBar();
+    void setBackgroundMode(bool background);
     
     // Core functionality
+    void initializeStorage();
+    void migrateLegacySettings();
     void loadPackages();
     void savePackages();
+    void flushPendingChanges();
+    void shutdownStorage();
+    void markDirty(const QString& trackingNumber);
+    void markRemoved(const QString& trackingNumber);
+    QString currentTrackingNumber() const;
+    void indexPackage(const QString& trackingNumber);
+    void indexLocations(const QString& trackingNumber, const QJsonObject& result);
+    void showListModel(QAbstractItemModel* model);
+    void startSearch(const QString& filterText);
+    void searchResultsReady(int begin, int end);
+    void cancelSearch();
+    QByteArray scheduleSnapshot() const;
+    void restoreSchedule(const QByteArray& snapshot);
+    void saveSchedule();
+    void archivePackages(const QStringList& trackingNumbers);
+    void archiveFinished(const QStringList& trackingNumbers, bool archived);
+    bool isArchivedInView(const QString& trackingNumber) const;
+    void trackNewPackage(const QString& trackingNumber, const QString& note);
+    void selectPackage(const QString& trackingNumber);
+    void requestDetails(const QString& trackingNumber);
+    void detailsLoaded(const QString& trackingNumber, const QJsonObject& details);
+    void recordPollResult(const QString& trackingNumber, const QJsonObject& info, const QDateTime& now);
+    PackageRecord toRecord(const QString& trackingNumber, const PackageData& package) const;
     void initializeTimers();
     void cleanupResources();
     std::optional<QString> validateTrackingNumber(const QString& number) const;
@@ -151,7 +222,8 @@ public:
 
 private:
     // UI Components
-    std::unique_ptr<QListWidget> packageList;
+    std::unique_ptr<PackageListModel> packageListModel;
+    std::unique_ptr<QListView> packageList;
     std::unique_ptr<QPushButton> addButton;
     std::unique_ptr<QPushButton> removeButton;
     std::unique_ptr<QPushButton> refreshButton;
@@ -163,19 +235,45 @@ private:
     // Core Components
     QSettings settings;
     std::unique_ptr<ShippoClient> shippoClient;
+    std::unique_ptr<PollScheduler> pollScheduler;
+    std::unique_ptr<QThread> persistenceThread;
+    std::unique_ptr<PersistenceWorker> persistenceWorker;
+    std::unique_ptr<ArchiveModel> archiveModel;
+    std::unique_ptr<QFutureWatcher<ImportSummary>> importWatcher;
+    bool importCommitting = false; // parsed records handed to the worker, not yet stored
+    std::unique_ptr<QFutureWatcher<QList<PackageRow>>> searchWatcher;
+    QList<PackageRow> searchRows; // rows streamed in so far by the running search
+    QList<QFuture<QList<PackageRow>>> abandonedSearches;
     std::unique_ptr<QSystemTrayIcon> trayIcon;
     std::unique_ptr<SettingsDialog> settingsDialog;
     std::unique_ptr<QWidget> container;
     std::unique_ptr<QVBoxLayout> containerLayout;
     
-    // Data Storage
+    // Data Storage: active packages only; archived ones live in the worker's ArchiveStore
     QMap<QString, PackageData> packages;
+    QSet<QString> archivedInView; // archived packages currently listed
+    QHash<QString, PackageRecord> archivingPackages; // handed to the worker, move not yet confirmed
+    SearchIndex searchIndex;      // trigram index over active packages
     std::queue<QString> updateQueue;
+    QSet<QString> queuedUpdates; // packages in updateQueue, so each is queued once
+    
+    // Rows changed since the last save; only these are written
+    QSet<QString> dirtyPackages;
+    QHash<QString, QJsonObject> dirtyResults;
+    
+    // Details tier: tracking results are loaded on demand and kept in an LRU
+    QCache<QString, QJsonObject> detailsCache{DETAILS_CACHE_SIZE};
+    QSet<QString> pendingDetailLoads;
+    QSet<QString> removedPackages;
     
     // Timers
     std::unique_ptr<QTimer> refreshTimer;
     std::unique_ptr<QTimer> retryTimer;
     std::unique_ptr<QTimer> queueProcessTimer;
+    std::unique_ptr<QTimer> archivalTimer;
+    std::unique_ptr<QTimer> saveTimer;
+    std::unique_ptr<QTimer> scheduleSaveTimer;
+    std::unique_ptr<QTimer> searchDebounceTimer;
     
     // State
     QPoint dragPosition;
@@ -185,10 +283,22 @@ private:
     // New member variable to track if archived packages are shown.
     bool showArchived = false;
     
+    // Power-aware mode while hidden; UI work is deferred until shown again
+    bool backgroundMode = false;
+    bool listRefreshPending = false;
+    
     // Mouse event handlers
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
+    
+    // Starts the deferred startup stage on the first paint
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    
+    // Visibility handlers
+    void changeEvent(QEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 };
 
 #endif // MAINWINDOW_H
@@ -1,7 +1,7 @@
 TEMPLATE = app
 TARGET = PackageTracker
 
-QT       += core gui widgets network
+QT       += core gui widgets network sql concurrent
 CONFIG   += c++17
 
 # Use Qt's built-in module paths
@@ -17,12 +17,51 @@ SOURCES += main.cpp \
            mainwindow.cpp \
            shippoclient.cpp \
            settingsdialog.cpp \
-           archivedpackageswindow.cpp
+           archivedpackageswindow.cpp \
+           pollscheduler.cpp \
+           scanintervalmodel.cpp \
+           budgetplanner.cpp \
+           sqlitepackagestore.cpp \
+           journalpackagestore.cpp \
+           persistenceworker.cpp \
+           archivestore.cpp \
+           resultcodec.cpp \
+           benchmark.cpp \
+           cachebenchmark.cpp \
+           archivemodel.cpp \
+           startuptimeline.cpp \
+           packagetransfer.cpp \
+           packagelistmodel.cpp \
+           searchindex.cpp \
+           packagequery.cpp \
+           querycli.cpp \
+           packageitemdelegate.cpp \
+           delegatebenchmark.cpp
 
 HEADERS += mainwindow.h \
            shippoclient.h \
            settingsdialog.h \
-           archivedpackageswindow.h
+           archivedpackageswindow.h \
+           pollscheduler.h \
+           scanintervalmodel.h \
+           budgetplanner.h \
+           packagestore.h \
+           sqlitepackagestore.h \
+           journalpackagestore.h \
+           persistenceworker.h \
+           archivestore.h \
+           resultcodec.h \
+           benchmark.h \
+           cachebenchmark.h \
+           archivemodel.h \
+           startuptimeline.h \
+           packagetransfer.h \
+           packagelistmodel.h \
+           searchindex.h \
+           packagequery.h \
+           querycli.h \
+           packageitemdelegate.h \
+           delegatebenchmark.h
 
 # macOS specific configuration
 QMAKE_MACOSX_DEPLOYMENT_TARGET = 14.0
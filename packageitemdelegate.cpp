@@ -0,0 +1,114 @@
+#include "packageitemdelegate.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <QtMath>
+
+namespace {
+
+constexpr std::array<QRgb, size_t(PackageStatus::Count)> STATUS_COLORS = {
+    0xff95a5a6, // Unknown: gray
+    0xff3498db, // PreTransit
+    0xfff39c12, // Transit
+    0xff27ae60, // Delivered
+    0xff9b59b6, // Returned
+    0xffe74c3c  // Failure
+};
+
+const QColor NOTE_COLOR(0x66, 0x66, 0x66);
+
+} // namespace
+
+PackageItemDelegate::PackageItemDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void PackageItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const PackageRow* row = index.data(PackageListModel::RenderRole).value<const PackageRow*>();
+    if (!row) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Draw background
+    QStyle* style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, option.widget);
+    updateFonts(option.font);
+
+    const QRect& rect = option.rect;
+    int iconTop = rect.top() + (rect.height() - STATUS_DOT_SIZE) / 2;
+    int iconLeft = rect.left() + PACKAGE_ROW_PADDING;
+    painter->drawPixmap(iconLeft, iconTop, statusDot(row->statusKind, painter->device()->devicePixelRatioF()));
+
+    // Draw tracking number
+    QRect textRect = rect;
+    textRect.setLeft(iconLeft + STATUS_DOT_SIZE + PACKAGE_ROW_PADDING * 2 - 1);
+    int textWidth = textMetrics->horizontalAdvance(row->displayText);
+    if (textWidth <= textRect.width()) {
+        painter->drawText(textRect, Qt::AlignVCenter, row->displayText);
+    } else {
+        painter->drawText(textRect, Qt::AlignVCenter,
+            textMetrics->elidedText(row->displayText, Qt::ElideRight, textRect.width()));
+        return;
+    }
+
+    // Draw note if present
+    if (row->noteText.isEmpty()) return;
+    QRect noteRect = rect;
+    noteRect.setLeft(textRect.left() + textWidth + PACKAGE_ROW_PADDING * 4);
+    if (noteRect.width() <= 0) return;
+
+    QFont previousFont = painter->font();
+    QPen previousPen = painter->pen();
+    painter->setFont(noteFont);
+    painter->setPen(NOTE_COLOR);
+    if (noteMetrics->horizontalAdvance(row->noteText) <= noteRect.width()) {
+        painter->drawText(noteRect, Qt::AlignVCenter, row->noteText);
+    } else {
+        painter->drawText(noteRect, Qt::AlignVCenter,
+            noteMetrics->elidedText(row->noteText, Qt::ElideRight, noteRect.width()));
+    }
+    painter->setFont(previousFont);
+    painter->setPen(previousPen);
+}
+
+QSize PackageItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.setHeight(size.height() + 8);
+    return size;
+}
+
+void PackageItemDelegate::updateFonts(const QFont& font) const
+{
+    if (textMetrics && font == textFont) return;
+
+    textFont = font;
+    noteFont = font;
+    noteFont.setItalic(true);
+    textMetrics.emplace(textFont);
+    noteMetrics.emplace(noteFont);
+}
+
+const QPixmap& PackageItemDelegate::statusDot(PackageStatus status, qreal devicePixelRatio) const
+{
+    // Antialiased ellipses are rendered once per color and screen density
+    if (devicePixelRatio != dotsRatio) {
+        dotsRatio = devicePixelRatio;
+        int side = qCeil(STATUS_DOT_SIZE * devicePixelRatio);
+        for (size_t i = 0; i < dots.size(); ++i) {
+            QPixmap dot(side, side);
+            dot.setDevicePixelRatio(devicePixelRatio);
+            dot.fill(Qt::transparent);
+            QPainter dotPainter(&dot);
+            dotPainter.setRenderHint(QPainter::Antialiasing);
+            dotPainter.setPen(Qt::NoPen);
+            dotPainter.setBrush(QColor::fromRgba(STATUS_COLORS[i]));
+            dotPainter.drawEllipse(QRectF(0, 0, STATUS_DOT_SIZE, STATUS_DOT_SIZE));
+            dots[i] = dot;
+        }
+    }
+    return dots[size_t(status)];
+}
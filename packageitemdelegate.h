@@ -0,0 +1,43 @@
+#ifndef PACKAGEITEMDELEGATE_H
+#define PACKAGEITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QFont>
+#include <QFontMetrics>
+#include <QPixmap>
+#include <array>
+#include <optional>
+#include "packagelistmodel.h"
+
+constexpr int STATUS_DOT_SIZE = 16;
+constexpr int PACKAGE_ROW_PADDING = 4;
+
+// Paints a status dot, the tracking number and an italic note for each
+// package row. Everything that doesn't depend on the row is cached: the
+// dots are pre-rendered once per color and device pixel ratio, and the
+// fonts and metrics once per view font. Per-row strings come precomputed
+// from the model's render record, so painting a row allocates nothing
+// unless its text has to be elided.
+class PackageItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit PackageItemDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    void updateFonts(const QFont& font) const;
+    const QPixmap& statusDot(PackageStatus status, qreal devicePixelRatio) const;
+
+    mutable QFont textFont;
+    mutable QFont noteFont;
+    mutable std::optional<QFontMetrics> textMetrics;
+    mutable std::optional<QFontMetrics> noteMetrics;
+    mutable std::array<QPixmap, size_t(PackageStatus::Count)> dots;
+    mutable qreal dotsRatio = 0;
+};
+
+#endif // PACKAGEITEMDELEGATE_H
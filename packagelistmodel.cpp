@@ -0,0 +1,246 @@
+#include "packagelistmodel.h"
+#include <algorithm>
+
+namespace {
+
+const QString ARCHIVED_SUFFIX = " [Archived]";
+
+} // namespace
+
+PackageListModel::PackageListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int PackageListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant PackageListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+
+    const PackageRow& row = rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        // Archived rows carry a little indicator after the tracking number
+        return row.archived ? row.trackingNumber + ARCHIVED_SUFFIX : row.trackingNumber;
+    case StatusRole:
+        return row.status;
+    case NoteRole:
+        return row.note;
+    case ArchivedRole:
+        return row.archived;
+    case TrackingNumberRole:
+        return row.trackingNumber;
+    case RenderRole:
+        if (!row.prepared) prepare(row);
+        return QVariant::fromValue(&row);
+    default:
+        return QVariant();
+    }
+}
+
+const PackageRow* PackageListModel::rowAt(int row) const
+{
+    return row >= 0 && row < rows.size() ? &rows.at(row) : nullptr;
+}
+
+QString PackageListModel::trackingNumberAt(int row) const
+{
+    const PackageRow* package = rowAt(row);
+    return package ? package->trackingNumber : QString();
+}
+
+int PackageListModel::rowOf(const QString& trackingNumber) const
+{
+    auto it = rowIndex.constFind(trackingNumber);
+    if (it != rowIndex.constEnd() && it.value() < indexedRows) return it.value();
+    if (indexedRows >= rows.size()) return -1;
+
+    // Rows after the last insert or removal have shifted; renumber them once
+    for (int row = indexedRows; row < rows.size(); ++row) {
+        rowIndex.insert(rows.at(row).trackingNumber, row);
+    }
+    indexedRows = rows.size();
+    return rowIndex.value(trackingNumber, -1);
+}
+
+void PackageListModel::updateRows(const QList<PackageRow>& newRows)
+{
+    // newRows must already be in rowLess order
+    if (countDiffRanges(newRows) > LIST_DIFF_MAX_RANGES) {
+        replaceLayout(newRows);
+    } else {
+        applyDiff(newRows);
+    }
+}
+
+int PackageListModel::addPackage(const PackageRow& package)
+{
+    auto it = std::lower_bound(rows.cbegin(), rows.cend(), package, rowLess);
+    int row = int(it - rows.cbegin());
+    beginInsertRows(QModelIndex(), row, row);
+    rows.insert(row, package);
+    invalidateIndexFrom(row);
+    endInsertRows();
+    return row;
+}
+
+void PackageListModel::removePackage(const QString& trackingNumber)
+{
+    int row = rowOf(trackingNumber);
+    if (row < 0) return;
+    beginRemoveRows(QModelIndex(), row, row);
+    rows.removeAt(row);
+    rowIndex.remove(trackingNumber);
+    invalidateIndexFrom(row);
+    endRemoveRows();
+}
+
+bool PackageListModel::setStatus(const QString& trackingNumber, const QString& status)
+{
+    int row = rowOf(trackingNumber);
+    if (row < 0 || rows.at(row).status == status) return false;
+    rows[row].status = status;
+    rows[row].prepared = false;
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { StatusRole });
+    return true;
+}
+
+void PackageListModel::setNote(const QString& trackingNumber, const QString& note)
+{
+    int row = rowOf(trackingNumber);
+    if (row < 0) return;
+    rows[row].note = note;
+    rows[row].prepared = false;
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { NoteRole });
+}
+
+bool PackageListModel::rowLess(const PackageRow& a, const PackageRow& b)
+{
+    if (a.rank != b.rank) return a.rank < b.rank;
+    if (a.archived != b.archived) return !a.archived;
+    return a.trackingNumber < b.trackingNumber;
+}
+
+PackageStatus PackageListModel::statusKind(const QString& trackingNumber, const QString& status)
+{
+    // Test numbers carry the status they simulate in their name
+    QStringView name = status;
+    if (trackingNumber.startsWith(QLatin1String("SHIPPO_"))) {
+        name = QStringView(trackingNumber).mid(7);
+    }
+
+    if (name.compare(QLatin1String("DELIVERED"), Qt::CaseInsensitive) == 0) return PackageStatus::Delivered;
+    if (name.compare(QLatin1String("TRANSIT"), Qt::CaseInsensitive) == 0) return PackageStatus::Transit;
+    if (name.compare(QLatin1String("PRE_TRANSIT"), Qt::CaseInsensitive) == 0) return PackageStatus::PreTransit;
+    if (name.compare(QLatin1String("FAILURE"), Qt::CaseInsensitive) == 0) return PackageStatus::Failure;
+    if (name.compare(QLatin1String("RETURNED"), Qt::CaseInsensitive) == 0) return PackageStatus::Returned;
+    return PackageStatus::Unknown;
+}
+
+void PackageListModel::prepare(const PackageRow& row)
+{
+    row.statusKind = statusKind(row.trackingNumber, row.status);
+    row.displayText = row.archived ? row.trackingNumber + ARCHIVED_SUFFIX : row.trackingNumber;
+    row.noteText = row.note.isEmpty() ? QString() : "- " + row.note;
+    row.prepared = true;
+}
+
+bool PackageListModel::rowDiffers(const PackageRow& a, const PackageRow& b)
+{
+    return a.status != b.status || a.note != b.note;
+}
+
+int PackageListModel::countDiffRanges(const QList<PackageRow>& newRows) const
+{
+    // Dry run of the merge in applyDiff, counting contiguous runs of each kind
+    enum Run { None, Removed, Inserted, Changed };
+    Run previous = None;
+    int ranges = 0;
+    qsizetype i = 0, j = 0;
+    while (i < rows.size() || j < newRows.size()) {
+        Run run;
+        if (j >= newRows.size() || (i < rows.size() && rowLess(rows.at(i), newRows.at(j)))) {
+            run = Removed;
+            ++i;
+        } else if (i >= rows.size() || rowLess(newRows.at(j), rows.at(i))) {
+            run = Inserted;
+            ++j;
+        } else {
+            run = rowDiffers(rows.at(i), newRows.at(j)) ? Changed : None;
+            ++i;
+            ++j;
+        }
+        if (run != None && run != previous) ++ranges;
+        previous = run;
+    }
+    return ranges;
+}
+
+void PackageListModel::applyDiff(const QList<PackageRow>& newRows)
+{
+    int row = 0;
+    qsizetype j = 0;
+    while (row < rows.size() || j < newRows.size()) {
+        if (j >= newRows.size() || (row < rows.size() && rowLess(rows.at(row), newRows.at(j)))) {
+            int end = row;
+            while (end < rows.size() && (j >= newRows.size() || rowLess(rows.at(end), newRows.at(j)))) ++end;
+            beginRemoveRows(QModelIndex(), row, end - 1);
+            for (int removed = row; removed < end; ++removed) {
+                rowIndex.remove(rows.at(removed).trackingNumber);
+            }
+            rows.remove(row, end - row);
+            invalidateIndexFrom(row);
+            endRemoveRows();
+        } else if (row >= rows.size() || rowLess(newRows.at(j), rows.at(row))) {
+            qsizetype end = j;
+            while (end < newRows.size() && (row >= rows.size() || rowLess(newRows.at(end), rows.at(row)))) ++end;
+            int count = int(end - j);
+            beginInsertRows(QModelIndex(), row, row + count - 1);
+            rows.insert(row, count, PackageRow());
+            std::copy(newRows.cbegin() + j, newRows.cbegin() + end, rows.begin() + row);
+            invalidateIndexFrom(row);
+            endInsertRows();
+            row += count;
+            j = end;
+        } else {
+            int first = row;
+            while (row < rows.size() && j < newRows.size() && !rowLess(rows.at(row), newRows.at(j))
+                && !rowLess(newRows.at(j), rows.at(row)) && rowDiffers(rows.at(row), newRows.at(j))) {
+                rows[row++] = newRows.at(j++);
+            }
+            if (row > first) {
+                emit dataChanged(index(first), index(row - 1), { StatusRole, NoteRole });
+            } else {
+                ++row;
+                ++j;
+            }
+        }
+    }
+}
+
+void PackageListModel::replaceLayout(const QList<PackageRow>& newRows)
+{
+    // Too scattered to apply range by range: swap the rows in one go and
+    // move the selection and current index to wherever their rows ended up
+    emit layoutAboutToBeChanged();
+    QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const QModelIndex& oldIndex : std::as_const(from)) {
+        const PackageRow& oldRow = rows.at(oldIndex.row());
+        auto it = std::lower_bound(newRows.cbegin(), newRows.cend(), oldRow, rowLess);
+        bool kept = it != newRows.cend() && !rowLess(oldRow, *it);
+        to.append(kept ? createIndex(int(it - newRows.cbegin()), 0) : QModelIndex());
+    }
+    rows = newRows;
+    rowIndex.clear();
+    indexedRows = 0;
+    changePersistentIndexList(from, to);
+    emit layoutChanged();
+}
@@ -0,0 +1,101 @@
+#ifndef PACKAGELISTMODEL_H
+#define PACKAGELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// A diff touching more separate ranges than this is applied as a single
+// layout change instead of one insert/remove per range
+constexpr int LIST_DIFF_MAX_RANGES = 64;
+
+// Statuses the list draws with their own color
+enum class PackageStatus : quint8 {
+    Unknown,
+    PreTransit,
+    Transit,
+    Delivered,
+    Returned,
+    Failure,
+    Count
+};
+
+// One visible row of the main package list
+struct PackageRow {
+    QString trackingNumber;
+    QString status;
+    QString note;
+    bool archived = false;
+    int rank = 0; // search relevance or sort position, lower first; 0 when not searching
+
+    // Render record, derived from the fields above the first time the row
+    // is painted (see PackageListModel::RenderRole)
+    mutable bool prepared = false;
+    mutable PackageStatus statusKind = PackageStatus::Unknown;
+    mutable QString displayText;
+    mutable QString noteText;
+};
+
+Q_DECLARE_METATYPE(const PackageRow*)
+
+// List model behind the main package view. Rows hold only what the
+// delegate draws, so a QListView with uniform item sizes only pays for the
+// rows on screen. Status and note edits update a single row in place.
+//
+// Rows are kept ordered by search rank, then active-first, then by tracking
+// number, so a new visible set can be diffed against the current one in a
+// single merge pass and applied as minimal inserts, removals and changes.
+// Selection and scroll position survive because untouched rows are never
+// reset.
+//
+// A hash from tracking number to row makes rowOf() O(1). Inserts and
+// removals only mark the rows after them as shifted; those are renumbered
+// in one pass on the next lookup that needs them.
+class PackageListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        StatusRole = Qt::UserRole,
+        NoteRole,
+        ArchivedRole,
+        TrackingNumberRole, // the bare tracking number, without the archived suffix
+        RenderRole          // const PackageRow*, with its render record filled in
+    };
+
+    explicit PackageListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    const PackageRow* rowAt(int row) const;
+    QString trackingNumberAt(int row) const;
+    int rowOf(const QString& trackingNumber) const;
+
+    // The model's row order; updateRows expects rows sorted by it
+    static bool rowLess(const PackageRow& a, const PackageRow& b);
+    static PackageStatus statusKind(const QString& trackingNumber, const QString& status);
+    // Fills in a row's render record; other models feeding the delegate use it too
+    static void prepare(const PackageRow& row);
+
+    void updateRows(const QList<PackageRow>& newRows);
+    int addPackage(const PackageRow& package);
+    void removePackage(const QString& trackingNumber);
+    bool setStatus(const QString& trackingNumber, const QString& status);
+    void setNote(const QString& trackingNumber, const QString& note);
+
+private:
+    static bool rowDiffers(const PackageRow& a, const PackageRow& b);
+    int countDiffRanges(const QList<PackageRow>& newRows) const;
+    void applyDiff(const QList<PackageRow>& newRows);
+    void replaceLayout(const QList<PackageRow>& newRows);
+    void invalidateIndexFrom(int row) { indexedRows = qMin(indexedRows, row); }
+
+    QList<PackageRow> rows;
+    mutable QHash<QString, int> rowIndex;
+    mutable int indexedRows = 0; // rows [0, indexedRows) have current rowIndex entries
+};
+
+#endif // PACKAGELISTMODEL_H
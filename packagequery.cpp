@@ -0,0 +1,254 @@
+#include "packagequery.h"
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+
+const QChar TERM_NEGATION = '-';
+
+} // namespace
+
+PackageQuery PackageQuery::parse(const QString& text, const QDateTime& now)
+{
+    PackageQuery query;
+    for (const QString& term : tokenize(text)) {
+        query.addTerm(term, now);
+    }
+    return query;
+}
+
+bool PackageQuery::matches(const PackageColumns& columns) const
+{
+    for (const Predicate& predicate : predicates) {
+        if (!predicate(columns)) return false;
+    }
+    return true;
+}
+
+QList<QueryMatch> PackageQuery::run(const SearchIndex& index, const ColumnsLookup& activeColumns,
+    const ArchiveLookup& archive, const std::function<bool()>& canceled) const
+{
+    QList<QueryMatch> matches;
+    stream(index, activeColumns, archive, [&matches](const QList<QueryMatch>& batch) { matches.append(batch); },
+        canceled);
+    if (canceled && canceled()) return {};
+    sort(matches);
+    return matches;
+}
+
+void PackageQuery::stream(const SearchIndex& index, const ColumnsLookup& activeColumns, const ArchiveLookup& archive,
+    const MatchSink& sink, const std::function<bool()>& canceled) const
+{
+    // Relevance tiers go out as soon as each is complete; other orders need everything
+    bool tiered = sortKey == SortRelevance;
+    QList<QueryMatch> matches;
+    auto deliver = [&]() {
+        if (matches.isEmpty()) return;
+        sort(matches);
+        sink(matches);
+        matches.clear();
+    };
+    auto rankOf = [this](const PackageColumns& columns, SearchIndex::MatchRank indexed) {
+        if (rankTerm.isEmpty()) return 0;
+        if (rankTerm == probe && indexed != SearchIndex::NoMatch) return int(indexed);
+        SearchIndex::MatchRank rank = SearchIndex::rankMatch(columns.trackingNumber, columns.note, rankTerm);
+        return int(rank == SearchIndex::NoMatch ? SearchIndex::OtherMatch : rank);
+    };
+
+    if (includesActive()) {
+        // Only packages containing the probe term are looked at
+        QList<SearchIndex::Match> candidates;
+        if (!probe.isEmpty()) {
+            candidates = index.search(probe);
+        } else {
+            for (const QString& trackingNumber : index.trackingNumbers()) {
+                candidates.append({ trackingNumber, SearchIndex::NoMatch });
+            }
+        }
+
+        // When the probe is also the rank term the index has already ranked
+        // every candidate, so exact and prefix hits can be checked first
+        qsizetype firstTier = 0;
+        if (tiered && !rankTerm.isEmpty() && rankTerm == probe) {
+            auto rest = std::stable_partition(candidates.begin(), candidates.end(),
+                [](const SearchIndex::Match& match) { return match.rank <= SearchIndex::PrefixMatch; });
+            firstTier = rest - candidates.begin();
+        }
+
+        for (qsizetype i = 0; i < candidates.size(); ++i) {
+            if (canceled && (i & 1023) == 0 && canceled()) return;
+            if (tiered && i == firstTier) deliver();
+            const SearchIndex::Match& candidate = candidates.at(i);
+            std::optional<PackageColumns> columns = activeColumns(candidate.trackingNumber);
+            if (!columns || !this->matches(*columns)) continue;
+            matches.append({ *columns, rankOf(*columns, candidate.rank) });
+        }
+        if (tiered) deliver();
+    }
+
+    // The probe only comes from tn:, note: and free text, and the archive
+    // matches it against the same tracking number, note and carrier that
+    // those terms check below, so pre-filtering with it never drops a match
+    if (canceled && canceled()) return;
+    const QList<PackageRecord> archived = includesArchived() && archive ? archive(probe) : QList<PackageRecord>();
+    for (const PackageRecord& record : archived) {
+        PackageColumns columns;
+        columns.trackingNumber = record.trackingNumber;
+        columns.status = record.status;
+        columns.carrier = record.carrier;
+        columns.note = record.note;
+        columns.archived = true;
+        columns.text = (record.trackingNumber + '\n' + record.note + '\n' + record.carrier).toLower();
+        if (!this->matches(columns)) continue;
+        matches.append({ columns, rankOf(columns, SearchIndex::NoMatch) });
+    }
+
+    if (canceled && canceled()) return;
+    deliver();
+}
+
+void PackageQuery::addTerm(const QString& term, const QDateTime& now)
+{
+    bool negated = term.size() > 1 && term.startsWith(TERM_NEGATION);
+    QString body = negated ? term.mid(1) : term;
+
+    static const QRegularExpression fieldPattern("^([a-z]+)(:|<=|>=|<|>)(.+)$",
+        QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch field = fieldPattern.match(body);
+    QString key = field.captured(1).toLower();
+    QString op = field.captured(2);
+    QString value = field.captured(3);
+    if (value.size() > 1 && value.startsWith('"') && value.endsWith('"')) {
+        value = value.mid(1, value.size() - 2);
+    }
+
+    Predicate predicate;
+    QString textTerm;
+
+    if (field.hasMatch() && op == ":" && (key == "status" || key == "carrier")) {
+        QStringList accepted = value.toUpper().split(',', Qt::SkipEmptyParts);
+        bool isStatus = key == "status";
+        predicate = [accepted, isStatus](const PackageColumns& columns) {
+            return accepted.contains((isStatus ? columns.status : columns.carrier).toUpper());
+        };
+    } else if (field.hasMatch() && op == ":" && (key == "note" || key == "tn" || key == "tracking")) {
+        QString needle = value.toLower();
+        bool isNote = key == "note";
+        predicate = [needle, isNote](const PackageColumns& columns) {
+            return (isNote ? columns.note : columns.trackingNumber).toLower().contains(needle);
+        };
+        textTerm = needle;
+    } else if (field.hasMatch() && op == ":" && key == "archived" && !negated) {
+        QString mode = value.toLower();
+        if (mode == "only") archivedMode = OnlyArchived;
+        else if (mode == "no" || mode == "false") archivedMode = NoArchived;
+        else archivedMode = AnyArchived;
+        return;
+    } else if (field.hasMatch() && op == ":" && key == "sort" && !negated) {
+        sortDescending = value.startsWith(TERM_NEGATION);
+        QString sortValue = sortDescending ? value.mid(1).toLower() : value.toLower();
+        if (sortValue == "eta") sortKey = SortEta;
+        else if (sortValue == "updated") sortKey = SortLastUpdate;
+        else sortKey = SortRelevance;
+        return;
+    } else if (field.hasMatch() && op != ":" && (key == "eta" || key == "updated")) {
+        std::optional<qint64> duration = parseDuration(value);
+        if (!duration) return;
+
+        // eta<2d: due within two days; updated<1d: polled within the last day
+        bool isEta = key == "eta";
+        QDateTime bound = isEta ? now.addMSecs(*duration) : now.addMSecs(-*duration);
+        bool below = op.startsWith('<');
+        bool inclusive = op.endsWith('=');
+        predicate = [isEta, bound, below, inclusive](const PackageColumns& columns) {
+            const QDateTime& when = isEta ? columns.eta : columns.lastUpdate;
+            if (!when.isValid()) return false;
+            // A more recent update is a smaller age, so the comparison flips
+            bool before = isEta == below;
+            return before ? (when < bound || (inclusive && when == bound))
+                          : (when > bound || (inclusive && when == bound));
+        };
+    } else {
+        QString needle = body.toLower();
+        if (needle.size() > 1 && needle.startsWith('"') && needle.endsWith('"')) {
+            needle = needle.mid(1, needle.size() - 2);
+        }
+        if (needle.isEmpty()) return;
+        predicate = [needle](const PackageColumns& columns) { return columns.text.contains(needle); };
+        textTerm = needle;
+        if (!negated && rankTerm.isEmpty()) rankTerm = needle;
+    }
+
+    if (negated) {
+        predicates.push_back([predicate](const PackageColumns& columns) { return !predicate(columns); });
+        return;
+    }
+    predicates.push_back(predicate);
+
+    // The longest positive text term narrows the candidates the most
+    if (textTerm.size() > probe.size()) probe = textTerm;
+}
+
+void PackageQuery::sort(QList<QueryMatch>& matches) const
+{
+    auto byRelevance = [](const QueryMatch& a, const QueryMatch& b) {
+        if (a.rank != b.rank) return a.rank < b.rank;
+        if (a.columns.archived != b.columns.archived) return !a.columns.archived;
+        return a.columns.trackingNumber < b.columns.trackingNumber;
+    };
+    if (sortKey == SortRelevance) {
+        std::sort(matches.begin(), matches.end(), byRelevance);
+        return;
+    }
+
+    // Packages without the key go last either way
+    bool byEta = sortKey == SortEta;
+    bool descending = sortDescending;
+    std::sort(matches.begin(), matches.end(), [byEta, descending, byRelevance](const QueryMatch& a, const QueryMatch& b) {
+        const QDateTime& left = byEta ? a.columns.eta : a.columns.lastUpdate;
+        const QDateTime& right = byEta ? b.columns.eta : b.columns.lastUpdate;
+        if (left.isValid() != right.isValid()) return left.isValid();
+        if (left != right) return descending ? left > right : left < right;
+        return byRelevance(a, b);
+    });
+    // The position becomes the rank, so views ordered by rank keep this order
+    for (int i = 0; i < matches.size(); ++i) {
+        matches[i].rank = i;
+    }
+}
+
+QStringList PackageQuery::tokenize(const QString& text)
+{
+    // Whitespace separates terms except inside double quotes
+    QStringList terms;
+    QString current;
+    bool quoted = false;
+    for (QChar c : text) {
+        if (c == '"') {
+            quoted = !quoted;
+            current += c;
+        } else if (c.isSpace() && !quoted) {
+            if (!current.isEmpty()) terms << current;
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.isEmpty()) terms << current;
+    return terms;
+}
+
+std::optional<qint64> PackageQuery::parseDuration(const QString& value)
+{
+    static const QRegularExpression durationPattern("^(-?\\d+)([mhdw])$", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = durationPattern.match(value);
+    if (!match.hasMatch()) return std::nullopt;
+
+    qint64 amount = match.captured(1).toLongLong();
+    switch (match.captured(2).toLower().at(0).unicode()) {
+    case 'm': return amount * 60 * 1000;
+    case 'h': return amount * 60 * 60 * 1000;
+    case 'd': return amount * 24 * 60 * 60 * 1000;
+    default: return amount * 7 * 24 * 60 * 60 * 1000;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef PACKAGEQUERY_H
+#define PACKAGEQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QList>
+#include <functional>
+#include <optional>
+#include <vector>
+#include "packagestore.h"
+#include "searchindex.h"
+
+// The columns a query can look at for one package
+struct PackageColumns {
+    QString trackingNumber;
+    QString status;
+    QString carrier;
+    QString note;
+    bool archived = false;
+    QDateTime eta;
+    QDateTime lastUpdate;
+    QString text; // lowercased searchable text, as indexed
+};
+
+struct QueryMatch {
+    PackageColumns columns;
+    int rank = 0; // relevance, or position once sorted by an explicit key
+};
+
+// Filter language for the package list, e.g.
+//     status:TRANSIT carrier:ups eta<2d note:"office" sort:eta
+// Terms are ANDed; a leading '-' negates one. Supported terms:
+//     status:A,B  carrier:A,B      exact, case-insensitive, any of the list
+//     note:text   tn:text          substring
+//     eta<2d  eta>4h  updated<1d   relative to now (units m, h, d, w)
+//     archived:yes|no|only
+//     sort:eta  sort:updated       '-' for descending, e.g. sort:-updated
+// Anything else is free text that must appear in the tracking number, note,
+// carrier or event locations. A query is parsed once into a list of
+// predicates over PackageColumns; its longest text term is answered by the
+// SearchIndex, and only those candidates are run through the predicates.
+class PackageQuery
+{
+public:
+    enum SortKey { SortRelevance, SortEta, SortLastUpdate };
+    using ColumnsLookup = std::function<std::optional<PackageColumns>(const QString& trackingNumber)>;
+    using ArchiveLookup = std::function<QList<PackageRecord>(const QString& filter)>;
+    using MatchSink = std::function<void(const QList<QueryMatch>& matches)>;
+
+    static PackageQuery parse(const QString& text, const QDateTime& now = QDateTime::currentDateTime());
+
+    bool isEmpty() const { return predicates.empty() && sortKey == SortRelevance; }
+    bool includesActive() const { return archivedMode != OnlyArchived; }
+    bool includesArchived() const { return archivedMode != NoArchived; }
+
+    bool matches(const PackageColumns& columns) const;
+
+    // Runs the query over the active packages in index and the archive, and
+    // returns the matches ordered for display
+    QList<QueryMatch> run(const SearchIndex& index, const ColumnsLookup& activeColumns,
+        const ArchiveLookup& archive, const std::function<bool()>& canceled = {}) const;
+
+    // The same matches, handed to sink as they are found, most relevant
+    // first: active exact and prefix hits, the other active hits, then the
+    // archive, which is only asked once the active ones are out. Each batch is
+    // in display order, but archived rows rank in between earlier ones. With
+    // an explicit sort key everything arrives in one batch.
+    void stream(const SearchIndex& index, const ColumnsLookup& activeColumns, const ArchiveLookup& archive,
+        const MatchSink& sink, const std::function<bool()>& canceled = {}) const;
+
+private:
+    enum ArchivedMode { AnyArchived, NoArchived, OnlyArchived };
+    using Predicate = std::function<bool(const PackageColumns&)>;
+
+    void addTerm(const QString& term, const QDateTime& now);
+    void sort(QList<QueryMatch>& matches) const;
+    static QStringList tokenize(const QString& text);
+    static std::optional<qint64> parseDuration(const QString& value);
+
+    std::vector<Predicate> predicates;
+    QString probe;        // lowercased text term to look up in the index
+    QString rankTerm;     // first free-text term, used for relevance
+    ArchivedMode archivedMode = AnyArchived;
+    SortKey sortKey = SortRelevance;
+    bool sortDescending = false;
+};
+
+#endif // PACKAGEQUERY_H
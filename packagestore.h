@@ -0,0 +1,95 @@
+#ifndef PACKAGESTORE_H
+#define PACKAGESTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCryptographicHash>
+
+// Index tier: the small per-package fields loaded eagerly at startup
+struct PackageRecord {
+    QString trackingNumber;
+    QString note;
+    QString status = "UNKNOWN";
+    QString carrier;
+    bool archived = false;
+    QDateTime terminalSince;
+    QStringList locations; // loaded for search; written through PackageChangeSet::locations
+};
+
+// Stable identity of a tracking event: the carrier's id when there is one,
+// otherwise a hash of what the event says happened
+inline QString trackingEventId(const QJsonObject& event)
+{
+    QString id = event["id"].toString();
+    if (!id.isEmpty()) return id;
+
+    QByteArray key = (event["timestamp"].toString() + '|' + event["status"].toString() + '|'
+        + event["location"].toString()).toUtf8();
+    return QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex().left(16));
+}
+
+// Distinct locations of a tracking history, in history order
+inline QStringList trackingEventLocations(const QJsonArray& events)
+{
+    QStringList locations;
+    for (const QJsonValue& value : events) {
+        QString location = value.toObject()["location"].toString();
+        if (!location.isEmpty() && !locations.contains(location)) locations << location;
+    }
+    return locations;
+}
+
+// A batch of mutations applied to the store in a single transaction.
+// Removals are applied first, so a package that is removed and upserted
+// again in the same batch starts over without its old result and events.
+struct PackageChangeSet {
+    QList<PackageRecord> upserts;
+    QStringList removals;
+    QHash<QString, QJsonObject> results;  // details tier: latest tracking result per package, minus its events
+    QHash<QString, QJsonArray> newEvents; // events appended to a package's history, in order
+    QHash<QString, QStringList> locations; // index tier: replaces a package's event locations
+
+    bool isEmpty() const
+    {
+        return upserts.isEmpty() && removals.isEmpty() && results.isEmpty() && newEvents.isEmpty()
+            && locations.isEmpty();
+    }
+
+    // Packages removed and not added back; their results and events are dropped
+    QSet<QString> droppedPackages() const
+    {
+        QSet<QString> dropped(removals.cbegin(), removals.cend());
+        for (const PackageRecord& record : upserts) dropped.remove(record.trackingNumber);
+        return dropped;
+    }
+};
+
+// Storage backend for packages and their cached tracking results. Writes are
+// per-row, so the cost of a save depends on what changed rather than on the
+// total number of packages. Only the index tier is loaded up front; cached
+// results (with their event histories) are fetched one package at a time.
+// Event histories are append-only: each event is stored once under its
+// trackingEventId, and loadResult() puts the history back into "events".
+class PackageStore
+{
+public:
+    virtual ~PackageStore() = default;
+
+    virtual bool open() = 0;
+    // For reading next to a running app: nothing is created, repaired or
+    // compacted, and apply() fails
+    virtual bool openReadOnly() = 0;
+    virtual bool isEmpty() = 0;
+    virtual QList<PackageRecord> loadPackages() = 0;
+    virtual QJsonObject loadResult(const QString& trackingNumber) = 0;
+    virtual QSet<QString> loadEventIds(const QString& trackingNumber) = 0;
+    virtual bool apply(const PackageChangeSet& changes) = 0;
+};
+
+#endif // PACKAGESTORE_H
@@ -0,0 +1,224 @@
+#include "packagetransfer.h"
+#include "shippoclient.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QtConcurrent>
+
+namespace {
+
+bool isJsonLines(const QString& path)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "jsonl" || suffix == "ndjson";
+}
+
+struct ImportRow {
+    QString trackingNumber;
+    QString note;
+    QString status;
+    QString carrier;
+    bool archived = false;
+};
+
+bool isTrue(const QString& value)
+{
+    QString flag = value.trimmed().toLower();
+    return flag == "1" || flag == "true" || flag == "yes";
+}
+
+} // namespace
+
+std::optional<QString> PackageImporter::validateTrackingNumber(const QString& number)
+{
+    if (number.isEmpty()) {
+        return std::nullopt;
+    }
+
+    static const QStringList validTestNumbers = {
+        "SHIPPO_PRE_TRANSIT",
+        "SHIPPO_TRANSIT",
+        "SHIPPO_DELIVERED",
+        "SHIPPO_RETURNED",
+        "SHIPPO_FAILURE",
+        "SHIPPO_UNKNOWN"
+    };
+
+    if (number.startsWith("SHIPPO_") && !validTestNumbers.contains(number)) {
+        return std::nullopt;
+    }
+
+    return number;
+}
+
+ImportSummary PackageImporter::importFile(const QString& path, const QSet<QString>& existing)
+{
+    ImportSummary summary;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        summary.error = file.errorString();
+        return summary;
+    }
+
+    QTextStream in(&file);
+    bool jsonLines = isJsonLines(path);
+    int trackingColumn = 0;
+    int noteColumn = 1;
+    int statusColumn = -1;
+    int carrierColumn = -1;
+    int archivedColumn = -1;
+    bool headerChecked = jsonLines;
+    QSet<QString> seen = existing;
+
+    while (!in.atEnd()) {
+        QList<ImportRow> chunk;
+        chunk.reserve(IMPORT_CHUNK_LINES);
+        while (chunk.size() < IMPORT_CHUNK_LINES && !in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            ++summary.lines;
+            if (line.isEmpty()) continue;
+
+            ImportRow row;
+            if (jsonLines) {
+                QJsonObject object = QJsonDocument::fromJson(line.toUtf8()).object();
+                row.trackingNumber = object["tracking_number"].toString();
+                row.note = object["note"].toString();
+                row.status = object["status"].toString();
+                row.carrier = object["carrier"].toString();
+                row.archived = object["archived"].toBool();
+            } else {
+                QStringList fields = parseCsvLine(line);
+                if (!headerChecked) {
+                    headerChecked = true;
+                    int column = fields.indexOf(QRegularExpression("tracking[ _]?(number)?",
+                        QRegularExpression::CaseInsensitiveOption));
+                    if (column >= 0) {
+                        trackingColumn = column;
+                        noteColumn = fields.indexOf(QRegularExpression("notes?",
+                            QRegularExpression::CaseInsensitiveOption));
+                        statusColumn = fields.indexOf(QRegularExpression("status",
+                            QRegularExpression::CaseInsensitiveOption));
+                        carrierColumn = fields.indexOf(QRegularExpression("carrier",
+                            QRegularExpression::CaseInsensitiveOption));
+                        archivedColumn = fields.indexOf(QRegularExpression("archived",
+                            QRegularExpression::CaseInsensitiveOption));
+                        continue;
+                    }
+                }
+                row.trackingNumber = fields.value(trackingColumn);
+                row.note = noteColumn >= 0 ? fields.value(noteColumn) : QString();
+                row.status = statusColumn >= 0 ? fields.value(statusColumn) : QString();
+                row.carrier = carrierColumn >= 0 ? fields.value(carrierColumn) : QString();
+                row.archived = archivedColumn >= 0 && isTrue(fields.value(archivedColumn));
+            }
+            chunk.append(row);
+        }
+
+        // Validation and carrier detection don't depend on other rows
+        QList<std::optional<PackageRecord>> parsed =
+            QtConcurrent::blockingMapped<QList<std::optional<PackageRecord>>>(chunk,
+                [](const ImportRow& row) -> std::optional<PackageRecord> {
+                    auto number = validateTrackingNumber(row.trackingNumber.trimmed());
+                    if (!number) return std::nullopt;
+                    PackageRecord record;
+                    record.trackingNumber = *number;
+                    record.note = row.note.trimmed();
+                    record.status = row.status.trimmed().isEmpty() ? "UNKNOWN" : row.status.trimmed();
+                    record.carrier = row.carrier.trimmed().isEmpty()
+                        ? ShippoClient::detectCarrier(*number) : row.carrier.trimmed();
+                    record.archived = row.archived;
+                    return record;
+                });
+
+        for (const auto& record : parsed) {
+            if (!record) {
+                ++summary.invalid;
+            } else if (seen.contains(record->trackingNumber)) {
+                ++summary.duplicates;
+            } else {
+                seen.insert(record->trackingNumber);
+                summary.records.append(*record);
+            }
+        }
+    }
+    return summary;
+}
+
+QStringList PackageImporter::parseCsvLine(const QString& line)
+{
+    // RFC 4180 quoting within a single line
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+    for (int i = 0; i < line.size(); ++i) {
+        QChar c = line.at(i);
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line.at(i + 1) == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+PackageExporter::PackageExporter(const QString& path)
+    : file(path), jsonLines(isJsonLines(path))
+{
+}
+
+bool PackageExporter::open()
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    out.setDevice(&file);
+    if (!jsonLines) {
+        out << "tracking_number,note,status,carrier,archived\n";
+    }
+    return true;
+}
+
+void PackageExporter::write(const QList<PackageRecord>& records)
+{
+    for (const PackageRecord& record : records) {
+        if (jsonLines) {
+            QJsonObject object;
+            object["tracking_number"] = record.trackingNumber;
+            object["note"] = record.note;
+            object["status"] = record.status;
+            object["carrier"] = record.carrier;
+            object["archived"] = record.archived;
+            out << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+        } else {
+            out << csvField(record.trackingNumber) << ',' << csvField(record.note) << ','
+                << csvField(record.status) << ',' << csvField(record.carrier) << ','
+                << (record.archived ? "1" : "0") << '\n';
+        }
+    }
+}
+
+bool PackageExporter::commit()
+{
+    out.flush();
+    return out.status() == QTextStream::Ok && file.commit();
+}
+
+QString PackageExporter::csvField(const QString& value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value;
+    QString escaped = value;
+    escaped.replace('"', "\"\"");
+    return QString("\"%1\"").arg(escaped);
+}
@@ -0,0 +1,60 @@
+#ifndef PACKAGETRANSFER_H
+#define PACKAGETRANSFER_H
+
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <optional>
+#include "packagestore.h"
+
+constexpr int IMPORT_CHUNK_LINES = 5000;  // lines parsed and validated per parallel pass
+constexpr int IMPORT_COMMIT_BATCH = 2000; // packages written per store transaction
+
+struct ImportSummary {
+    QList<PackageRecord> records; // new, valid, deduplicated packages in file order
+    int lines = 0;
+    int duplicates = 0;
+    int invalid = 0;
+    QString error;
+};
+
+// Streams tracking numbers in from a CSV or JSONL file (chosen by suffix).
+// The file is read a chunk at a time; each chunk is validated and has its
+// carrier detected in parallel, then deduplicated against the existing
+// packages and earlier rows. CSV files may start with a header naming a
+// "tracking_number" column and optional "note", "status", "carrier" and
+// "archived" columns, as PackageExporter writes them; otherwise the first
+// two columns are the tracking number and note. JSONL lines are objects with
+// the same keys. A missing status is UNKNOWN and a missing carrier is
+// detected from the number.
+class PackageImporter
+{
+public:
+    static std::optional<QString> validateTrackingNumber(const QString& number);
+    static ImportSummary importFile(const QString& path, const QSet<QString>& existing);
+
+private:
+    static QStringList parseCsvLine(const QString& line);
+};
+
+// Writes packages out in the same CSV or JSONL format, a batch at a time,
+// and only replaces the destination once everything has been written.
+class PackageExporter
+{
+public:
+    explicit PackageExporter(const QString& path);
+
+    bool open();
+    void write(const QList<PackageRecord>& records);
+    bool commit();
+    QString errorString() const { return file.errorString(); }
+
+private:
+    static QString csvField(const QString& value);
+
+    QSaveFile file;
+    QTextStream out;
+    bool jsonLines = false;
+};
+
+#endif // PACKAGETRANSFER_H
@@ -0,0 +1,369 @@
+#include "persistenceworker.h"
+#include "packagetransfer.h"
+#include "sqlitepackagestore.h"
+#include "journalpackagestore.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QTimer>
+#include <QDebug>
+
+PersistenceWorker::PersistenceWorker(StoreFactory factory, const QString& archivePath,
+    const QString& schedulePath, QObject* parent)
+    : QObject(parent), factory(std::move(factory)), archivePath(archivePath), schedulePath(schedulePath)
+{
+}
+
+PersistenceWorker::~PersistenceWorker() = default;
+
+PersistenceWorker::StoreFactory PersistenceWorker::storeFactory(const QString& dataDir, const QString& backend)
+{
+    bool useJournal = backend == "journal";
+    return [useJournal, dataDir]() -> std::unique_ptr<PackageStore> {
+        if (useJournal) {
+            return std::make_unique<JournalPackageStore>(dataDir);
+        }
+        return std::make_unique<SqlitePackageStore>(dataDir + "/packages.db");
+    };
+}
+
+bool PersistenceWorker::open()
+{
+    store = factory();
+    archive = std::make_unique<ArchiveStore>(archivePath);
+    bool archiveOpened = archive->open();
+    return store && store->open() && archiveOpened;
+}
+
+bool PersistenceWorker::openReadOnly()
+{
+    store = factory();
+    archive = std::make_unique<ArchiveStore>(archivePath);
+    readOnly = true;
+    bool archiveOpened = archive->openReadOnly();
+    return store && store->openReadOnly() && archiveOpened;
+}
+
+bool PersistenceWorker::importIfEmpty(const PackageChangeSet& changes)
+{
+    if (!store) return false;
+    if (!store->isEmpty()) return true;
+    return store->apply(changes);
+}
+
+QList<PackageRecord> PersistenceWorker::loadPackages()
+{
+    if (!store) return QList<PackageRecord>();
+
+    // A crash between writing the archive and deleting the rows it replaced
+    // leaves a package in both tiers; the archived copy is the newer one
+    QList<PackageRecord> records = store->loadPackages();
+    PackageChangeSet duplicates;
+    records.removeIf([this, &duplicates](const PackageRecord& record) {
+        if (!archive || !archive->contains(record.trackingNumber)) return false;
+        duplicates.removals.append(record.trackingNumber);
+        return true;
+    });
+    if (!readOnly && !store->apply(duplicates)) {
+        qDebug() << "Failed to drop" << duplicates.removals.size() << "archived packages from the store";
+    }
+    return records;
+}
+
+QJsonObject PersistenceWorker::loadResult(const QString& trackingNumber)
+{
+    // A result that hasn't been flushed yet is newer than what's on disk
+    auto pending = pendingResults.constFind(trackingNumber);
+    if (pending != pendingResults.constEnd()) return pending.value();
+    if (pendingRemovals.contains(trackingNumber)) return QJsonObject();
+
+    if (archive && archive->contains(trackingNumber)) {
+        auto archived = archive->get(trackingNumber);
+        return archived ? archived->result : QJsonObject();
+    }
+    return store ? store->loadResult(trackingNumber) : QJsonObject();
+}
+
+void PersistenceWorker::enqueue(const PackageChangeSet& changes)
+{
+    // A removal stays queued even if the package is added back before the
+    // flush; the store applies it first, so the old result and events go
+    for (const QString& trackingNumber : changes.removals) {
+        pendingUpserts.remove(trackingNumber);
+        pendingResults.remove(trackingNumber);
+        pendingRemovals.insert(trackingNumber);
+    }
+    for (const auto& record : changes.upserts) {
+        pendingUpserts.insert(record.trackingNumber, record);
+    }
+    for (auto it = changes.results.constBegin(); it != changes.results.constEnd(); ++it) {
+        pendingResults.insert(it.key(), it.value());
+    }
+
+    // Let any change sets already queued behind this one merge before writing
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QTimer::singleShot(0, this, &PersistenceWorker::flush);
+    }
+}
+
+qsizetype PersistenceWorker::importPackages(const QList<PackageRecord>& records)
+{
+    if (!store) return 0;
+
+    // Queued removals land first, taking old histories with them; if that
+    // write fails, a re-imported package must not be deleted by it later
+    flush();
+    for (const PackageRecord& record : records) {
+        pendingRemovals.remove(record.trackingNumber);
+    }
+
+    // Bounded transactions keep the store responsive during large imports.
+    // Packages exported from the archive go back into it, without a result;
+    // they're written first and taken back out if the batch fails
+    for (qsizetype start = 0; start < records.size(); start += IMPORT_COMMIT_BATCH) {
+        PackageChangeSet changes;
+        QList<ArchivedPackage> archived;
+        QStringList archivedNumbers;
+        for (const PackageRecord& record : records.mid(start, IMPORT_COMMIT_BATCH)) {
+            if (record.archived) {
+                ArchivedPackage package;
+                package.record = record;
+                archived.append(package);
+                archivedNumbers.append(record.trackingNumber);
+            } else {
+                changes.upserts.append(record);
+            }
+        }
+        if (!archived.isEmpty() && (!archive || !archive->put(archived))) return start;
+        if (!changes.upserts.isEmpty() && !store->apply(changes)) {
+            if (!archived.isEmpty()) archive->remove(archivedNumbers);
+            return start;
+        }
+    }
+    return records.size();
+}
+
+bool PersistenceWorker::exportPackages(const QString& path, const QList<PackageRecord>& activeRecords,
+    QString* error)
+{
+    PackageExporter exporter(path);
+    if (!exporter.open()) {
+        *error = exporter.errorString();
+        return false;
+    }
+    exporter.write(activeRecords);
+
+    // The archive is streamed out a page at a time
+    QString after;
+    QList<PackageRecord> page;
+    while (archive && !(page = archive->page(after, IMPORT_COMMIT_BATCH)).isEmpty()) {
+        exporter.write(page);
+        after = page.last().trackingNumber;
+    }
+
+    if (!exporter.commit()) {
+        *error = exporter.errorString();
+        return false;
+    }
+    return true;
+}
+
+QByteArray PersistenceWorker::loadSchedule() const
+{
+    QFile file(schedulePath);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    return file.readAll();
+}
+
+bool PersistenceWorker::saveSchedule(const QByteArray& snapshot)
+{
+    // Replaced atomically so a crash mid-write keeps the previous schedule
+    QSaveFile file(schedulePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(snapshot) != snapshot.size() || !file.commit()) {
+        qDebug() << "Failed to save poll schedule:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool PersistenceWorker::archivePackages(const QList<PackageRecord>& records)
+{
+    QStringList trackingNumbers;
+    for (const auto& record : records) trackingNumbers.append(record.trackingNumber);
+    if (!store || !archive || records.isEmpty()) {
+        emit packagesArchived(trackingNumbers, false);
+        return false;
+    }
+
+    // Results still queued for these packages must make it into the archive
+    flush();
+
+    QList<ArchivedPackage> packages;
+    PackageChangeSet removals;
+    for (const auto& record : records) {
+        ArchivedPackage package;
+        package.record = record;
+        package.record.archived = true;
+        package.result = loadResult(record.trackingNumber);
+        packages.append(package);
+        removals.removals.append(record.trackingNumber);
+    }
+
+    // Write the archive first so a failure never loses a package; if the
+    // store can't let go of them, take them back out so they live in one tier
+    bool archived = archive->put(packages);
+    if (archived && !store->apply(removals)) {
+        archive->remove(trackingNumbers);
+        archived = false;
+    }
+    if (archived) {
+        // Writes still pending from a failed flush would bring them back
+        for (const QString& trackingNumber : std::as_const(trackingNumbers)) {
+            pendingUpserts.remove(trackingNumber);
+            pendingResults.remove(trackingNumber);
+        }
+    }
+    emit packagesArchived(trackingNumbers, archived);
+    return archived;
+}
+
+QList<ArchivedPackage> PersistenceWorker::unarchivePackages(const QStringList& trackingNumbers)
+{
+    QList<ArchivedPackage> restored;
+    if (!store || !archive) return restored;
+
+    PackageChangeSet changes;
+    for (const QString& trackingNumber : trackingNumbers) {
+        auto package = archive->get(trackingNumber);
+        if (!package) continue;
+        package->record.archived = false;
+        changes.upserts.append(package->record);
+        if (!package->result.isEmpty()) {
+            stageResult(trackingNumber, package->result, changes);
+        }
+        restored.append(*package);
+    }
+
+    if (restored.isEmpty() || !store->apply(changes)) return QList<ArchivedPackage>();
+    if (!archive->remove(trackingNumbers)) {
+        // Left in both tiers, the next start would archive them again
+        PackageChangeSet undo;
+        for (const ArchivedPackage& package : std::as_const(restored)) {
+            undo.removals.append(package.record.trackingNumber);
+        }
+        store->apply(undo);
+        return QList<ArchivedPackage>();
+    }
+    return restored;
+}
+
+QList<PackageRecord> PersistenceWorker::queryArchive(const QString& filter) const
+{
+    return archive ? archive->search(filter) : QList<PackageRecord>();
+}
+
+QStringList PersistenceWorker::archivedTrackingNumbers() const
+{
+    return archive ? archive->trackingNumbers() : QStringList();
+}
+
+bool PersistenceWorker::isArchived(const QString& trackingNumber) const
+{
+    return archive && archive->contains(trackingNumber);
+}
+
+QList<PackageRecord> PersistenceWorker::archivePage(const QString& after, int limit) const
+{
+    return archive ? archive->page(after, limit) : QList<PackageRecord>();
+}
+
+void PersistenceWorker::setArchivedNote(const QString& trackingNumber, const QString& note)
+{
+    if (!archive) return;
+    auto package = archive->get(trackingNumber);
+    if (!package || package->record.note == note) return;
+    package->record.note = note;
+    archive->put({ *package });
+}
+
+void PersistenceWorker::removeFromArchive(const QStringList& trackingNumbers)
+{
+    if (archive) archive->remove(trackingNumbers);
+}
+
+bool PersistenceWorker::flush()
+{
+    flushScheduled = false;
+    if (pendingUpserts.isEmpty() && pendingRemovals.isEmpty() && pendingResults.isEmpty()) return true;
+    if (!store) return false;
+
+    PackageChangeSet changes;
+    changes.upserts = pendingUpserts.values();
+    changes.removals = QStringList(pendingRemovals.cbegin(), pendingRemovals.cend());
+
+    QHash<QString, int> appended;
+    for (auto it = pendingResults.constBegin(); it != pendingResults.constEnd(); ++it) {
+        int count = stageResult(it.key(), it.value(), changes);
+        if (count > 0) appended.insert(it.key(), count);
+    }
+
+    // One transaction per flush: after a crash the store holds either the
+    // whole batch or none of it. On failure keep everything and try again.
+    if (!store->apply(changes)) {
+        qDebug() << "Deferred package write failed; retrying in" << FLUSH_RETRY_INTERVAL << "ms";
+        if (!flushScheduled) {
+            flushScheduled = true;
+            QTimer::singleShot(FLUSH_RETRY_INTERVAL, this, &PersistenceWorker::flush);
+        }
+        return false;
+    }
+
+    pendingUpserts.clear();
+    pendingRemovals.clear();
+    pendingResults.clear();
+
+    for (auto it = appended.constBegin(); it != appended.constEnd(); ++it) {
+        emit eventsAppended(it.key(), it.value());
+    }
+    return true;
+}
+
+int PersistenceWorker::stageResult(const QString& trackingNumber, const QJsonObject& result,
+    PackageChangeSet& changes)
+{
+    // Responses repeat the whole history; keep only the events not stored yet
+    QJsonObject summary = result;
+    QJsonArray history = summary.take("events").toArray();
+    changes.results.insert(trackingNumber, summary);
+
+    // Kept with the package's index fields so search has them at startup
+    QStringList locations = trackingEventLocations(history);
+    if (!locations.isEmpty()) changes.locations.insert(trackingNumber, locations);
+
+    // A package removed in this batch is stored again from an empty history
+    QSet<QString> known = changes.removals.contains(trackingNumber)
+        ? QSet<QString>() : store->loadEventIds(trackingNumber);
+    bool firstHistory = known.isEmpty();
+    QJsonArray fresh;
+    for (const QJsonValue& value : history) {
+        QJsonObject event = value.toObject();
+        QString id = trackingEventId(event);
+        if (known.contains(id)) continue;
+        known.insert(id);
+        event["id"] = id;
+        fresh.append(event);
+    }
+    if (fresh.isEmpty()) return 0;
+
+    changes.newEvents.insert(trackingNumber, fresh);
+    // The first history stored for a package isn't news
+    return firstHistory ? 0 : fresh.size();
+}
+
+bool PersistenceWorker::shutdown()
+{
+    bool flushed = flush();
+    store.reset();
+    archive.reset();
+    return flushed;
+}
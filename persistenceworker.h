@@ -0,0 +1,85 @@
+#ifndef PERSISTENCEWORKER_H
+#define PERSISTENCEWORKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <functional>
+#include <memory>
+#include "packagestore.h"
+#include "archivestore.h"
+
+constexpr int FLUSH_RETRY_INTERVAL = 5000; // a failed write is tried again after 5 seconds
+
+// Owns the package store on a dedicated thread. Change sets posted from
+// the GUI thread are merged (later changes to the same package win, a
+// removal cancels pending writes) and written in one transaction once the
+// queue drains, so bursts of edits cost a single write. Only tracking events
+// the store hasn't seen yet are written with a result. Archived packages
+// are moved out of the store into a compressed ArchiveStore. The poll
+// schedule is kept next to the store as an opaque snapshot.
+class PersistenceWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    using StoreFactory = std::function<std::unique_ptr<PackageStore>()>;
+
+    // The configured backend: "sqlite" (default) or "journal"
+    static StoreFactory storeFactory(const QString& dataDir, const QString& backend);
+
+    PersistenceWorker(StoreFactory factory, const QString& archivePath, const QString& schedulePath,
+        QObject* parent = nullptr);
+    ~PersistenceWorker() override;
+
+    // These must run on the worker thread
+    bool open();
+    bool openReadOnly(); // for listing next to a running app; nothing is ever written
+    bool importIfEmpty(const PackageChangeSet& changes);
+    QList<PackageRecord> loadPackages();
+    QJsonObject loadResult(const QString& trackingNumber);
+    void enqueue(const PackageChangeSet& changes);
+    // Returns how many records were committed; batches before a failure stay
+    qsizetype importPackages(const QList<PackageRecord>& records);
+    bool exportPackages(const QString& path, const QList<PackageRecord>& activeRecords, QString* error);
+    QByteArray loadSchedule() const;
+    bool saveSchedule(const QByteArray& snapshot);
+
+    // Archive tier
+    bool archivePackages(const QList<PackageRecord>& records);
+    QList<ArchivedPackage> unarchivePackages(const QStringList& trackingNumbers);
+    QList<PackageRecord> queryArchive(const QString& filter) const;
+    QList<PackageRecord> archivePage(const QString& after, int limit) const;
+    QStringList archivedTrackingNumbers() const;
+    bool isArchived(const QString& trackingNumber) const;
+    void setArchivedNote(const QString& trackingNumber, const QString& note);
+    void removeFromArchive(const QStringList& trackingNumbers);
+
+signals:
+    // Emitted after a write that extended a package's stored event history
+    void eventsAppended(const QString& trackingNumber, int count);
+    // Outcome of archivePackages(); on failure the packages are still active
+    void packagesArchived(const QStringList& trackingNumbers, bool archived);
+
+public slots:
+    bool flush();
+    // Writes what is pending and closes the stores; false if changes were lost
+    bool shutdown();
+
+private:
+    int stageResult(const QString& trackingNumber, const QJsonObject& result, PackageChangeSet& changes);
+
+    StoreFactory factory;
+    QString archivePath;
+    QString schedulePath;
+    std::unique_ptr<PackageStore> store;
+    std::unique_ptr<ArchiveStore> archive;
+
+    QHash<QString, PackageRecord> pendingUpserts;
+    QSet<QString> pendingRemovals;
+    QHash<QString, QJsonObject> pendingResults;
+    bool flushScheduled = false;
+    bool readOnly = false;
+};
+
+#endif // PERSISTENCEWORKER_H
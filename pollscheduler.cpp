@@ -0,0 +1,333 @@
+#include "pollscheduler.h"
+#include <QJsonArray>
+#include <QtGlobal>
+#include <QList>
+#include <QRandomGenerator>
+#include <algorithm>
+
+PollScheduler::PollScheduler(qint64 baseIntervalMs)
+    : baseIntervalMs(baseIntervalMs)
+{
+}
+
+void PollScheduler::track(const QString& trackingNumber, const QDateTime& now)
+{
+    if (states.contains(trackingNumber)) return;
+
+    PollState state;
+    state.nextDue = now.addMSecs(phaseOffset(trackingNumber));
+    states.insert(trackingNumber, state);
+    budgetDirty = true;
+}
+
+void PollScheduler::untrack(const QString& trackingNumber)
+{
+    if (states.remove(trackingNumber)) budgetDirty = true;
+}
+
+bool PollScheduler::isTracked(const QString& trackingNumber) const
+{
+    return states.contains(trackingNumber);
+}
+
+void PollScheduler::recordResult(const QString& trackingNumber, const QJsonObject& info, const QDateTime& now)
+{
+    auto it = states.find(trackingNumber);
+    if (it == states.end()) return;
+
+    PollState& state = it.value();
+    state.status = info["status"].toString("UNKNOWN");
+    state.substatus = info["substatus"].toString();
+    state.estimatedDelivery = parseTimestamp(info["estimatedDelivery"].toString());
+    state.lastSuccessfulPoll = now;
+    state.carrier = info["carrier"].toString();
+
+    QString fromState = info["address_from"].toObject()["state"].toString();
+    QString toState = info["address_to"].toObject()["state"].toString();
+    state.lane = (fromState.isEmpty() || toState.isEmpty()) ? QString() : fromState + ">" + toState;
+
+    // Feed only scans newer than the last one we saw into the interval model,
+    // and track the most recent scan so quiet packages can back off
+    QDateTime previous = state.lastEventTime;
+    for (const QDateTime& eventTime : eventTimes(info)) {
+        if (previous.isValid() && eventTime <= previous) continue;
+        if (previous.isValid()) {
+            scanModel.observeGap(state.carrier, state.lane, previous.msecsTo(eventTime));
+        }
+        previous = eventTime;
+    }
+    state.lastEventTime = previous;
+    state.eventsSeeded = true;
+
+    state.nextDue = computeNextDue(trackingNumber, state, now, intervalScale);
+    state.scheduledInBackground = intervalScale > 1.0;
+    budgetDirty = true;
+}
+
+void PollScheduler::recordFailure(const QString& trackingNumber, const QDateTime& now)
+{
+    auto it = states.find(trackingNumber);
+    if (it == states.end()) return;
+
+    // Short-term retries are handled by the retry timer; just push the
+    // regular schedule out so a failing package doesn't stay due.
+    it.value().nextDue = now.addMSecs(baseIntervalMs + jitter(baseIntervalMs));
+}
+
+void PollScheduler::recordAttempt(const QString& trackingNumber, const QDateTime& now)
+{
+    auto it = states.find(trackingNumber);
+    if (it == states.end() || !it.value().nextDue.isValid()) return;
+
+    // Keep the package from coming due again while its request is out; the
+    // result or failure reschedules it
+    it.value().nextDue = qMax(it.value().nextDue, now.addMSecs(baseIntervalMs));
+}
+
+bool PollScheduler::needsEventSeed(const QString& trackingNumber) const
+{
+    auto it = states.constFind(trackingNumber);
+    return it != states.constEnd() && !it.value().eventsSeeded;
+}
+
+void PollScheduler::seedEvents(const QString& trackingNumber, const QJsonObject& storedResult)
+{
+    auto it = states.find(trackingNumber);
+    if (it == states.end()) return;
+
+    PollState& state = it.value();
+    QList<QDateTime> times = eventTimes(storedResult);
+    if (!times.isEmpty() && (!state.lastEventTime.isValid() || times.last() > state.lastEventTime)) {
+        state.lastEventTime = times.last();
+    }
+    state.eventsSeeded = true;
+}
+
+QStringList PollScheduler::duePackages(const QDateTime& now) const
+{
+    QStringList due;
+    if (budgetPlanner.isExhausted(now.date())) return due;
+
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        const QDateTime& nextDue = it.value().nextDue;
+        if (nextDue.isValid() && nextDue <= now) {
+            due << it.key();
+        }
+    }
+    return due;
+}
+
+void PollScheduler::catchUp(const QDateTime& now)
+{
+    // Polls pushed out while in the background are re-planned at the
+    // foreground rate, counted from the last poll. The budget floor still
+    // applies, and packages that are already overdue are spread over the
+    // base interval like newly tracked ones rather than all firing now.
+    for (auto it = states.begin(); it != states.end(); ++it) {
+        PollState& state = it.value();
+        if (!state.scheduledInBackground || !state.nextDue.isValid()) continue;
+        state.scheduledInBackground = false;
+        if (!state.lastSuccessfulPoll.isValid()) continue;
+
+        QDateTime foreground = computeNextDue(it.key(), state, state.lastSuccessfulPoll, 1.0, false);
+        if (!foreground.isValid()) continue;
+        if (foreground < now) foreground = now.addMSecs(phaseOffset(it.key()));
+        state.nextDue = qMin(state.nextDue, foreground);
+    }
+}
+
+void PollScheduler::saveState(QDataStream& out) const
+{
+    out << static_cast<qint32>(states.size());
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        const PollState& state = it.value();
+        out << it.key() << state.status << state.substatus << state.carrier << state.lane
+            << state.estimatedDelivery << state.lastEventTime << state.lastSuccessfulPoll << state.nextDue;
+    }
+}
+
+bool PollScheduler::restoreState(QDataStream& in)
+{
+    qint32 count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString trackingNumber;
+        PollState state;
+        in >> trackingNumber >> state.status >> state.substatus >> state.carrier >> state.lane
+           >> state.estimatedDelivery >> state.lastEventTime >> state.lastSuccessfulPoll >> state.nextDue;
+
+        // Packages added or removed since the state was saved keep their fresh schedule
+        auto it = states.find(trackingNumber);
+        if (it == states.end() || in.status() != QDataStream::Ok) continue;
+        state.eventsSeeded = true;
+        it.value() = state;
+    }
+    budgetDirty = true;
+    return in.status() == QDataStream::Ok;
+}
+
+void PollScheduler::replanBudget(const QDateTime& now)
+{
+    QList<BudgetPlanner::Demand> demands;
+    demands.reserve(states.size());
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        qint64 interval = heuristicInterval(it.value(), now);
+        if (interval <= 0) continue;
+
+        BudgetPlanner::Demand demand;
+        demand.trackingNumber = it.key();
+        demand.gain = informationGain(it.value(), now);
+        demand.pollsPerDay = static_cast<double>(MS_PER_DAY) / interval;
+        demands.append(demand);
+    }
+
+    budgetPlanner.plan(demands);
+    budgetDirty = false;
+    lastBudgetPlan = now;
+}
+
+void PollScheduler::replanBudgetIfNeeded(const QDateTime& now)
+{
+    if (budgetDirty || !lastBudgetPlan.isValid() || lastBudgetPlan.msecsTo(now) >= BUDGET_REPLAN_INTERVAL) {
+        replanBudget(now);
+    }
+}
+
+QDateTime PollScheduler::nextDue(const QString& trackingNumber) const
+{
+    return states.value(trackingNumber).nextDue;
+}
+
+qint64 PollScheduler::phaseOffset(const QString& trackingNumber) const
+{
+    if (baseIntervalMs <= 0) return 0;
+    return static_cast<qint64>(qHash(trackingNumber) % static_cast<quint64>(baseIntervalMs));
+}
+
+bool PollScheduler::isTerminalStatus(const QString& status)
+{
+    return status == "DELIVERED" || status == "RETURNED" || status == "FAILURE";
+}
+
+QDateTime PollScheduler::parseTimestamp(const QString& value)
+{
+    if (value.isEmpty()) return QDateTime();
+
+    QDateTime dateTime = QDateTime::fromString(value, Qt::ISODateWithMs);
+    if (!dateTime.isValid()) {
+        dateTime = QDateTime::fromString(value, Qt::ISODate);
+    }
+    if (!dateTime.isValid()) {
+        dateTime = QDateTime::fromString(value, "yyyyMMdd HHmmss");
+    }
+    return dateTime;
+}
+
+qint64 PollScheduler::heuristicInterval(const PollState& state, const QDateTime& now) const
+{
+    if (isTerminalStatus(state.status)) return -1;
+
+    if (state.substatus == "OUT_FOR_DELIVERY" || state.substatus == "DELIVERY_ATTEMPTED") {
+        return POLL_INTERVAL_DELIVERY_WINDOW;
+    }
+
+    if (state.estimatedDelivery.isValid()) {
+        qint64 msToEta = now.msecsTo(state.estimatedDelivery);
+        if (qAbs(msToEta) <= DELIVERY_WINDOW_MARGIN) return POLL_INTERVAL_DELIVERY_WINDOW;
+        if (msToEta < 0) return POLL_INTERVAL_OVERDUE;
+        if (msToEta <= NEAR_ETA_HORIZON) return POLL_INTERVAL_NEAR_ETA;
+        return POLL_INTERVAL_FAR_FROM_ETA;
+    }
+
+    // No ETA: back off once the carrier has gone quiet for a day
+    if (state.lastEventTime.isValid() && state.lastEventTime.msecsTo(now) > 24 * 60 * 60 * 1000) {
+        return POLL_INTERVAL_QUIET;
+    }
+
+    return baseIntervalMs;
+}
+
+qint64 PollScheduler::intervalFor(const PollState& state, const QDateTime& now, bool countSavings)
+{
+    qint64 heuristic = heuristicInterval(state, now);
+    if (heuristic < 0 || heuristic == POLL_INTERVAL_DELIVERY_WINDOW) return heuristic;
+
+    // A scan that is already late tells us nothing new; keep the heuristic
+    auto predicted = scanModel.predictNextScan(state.carrier, state.lane, state.lastEventTime);
+    if (!predicted || *predicted <= now) return heuristic;
+
+    qint64 modelInterval = qBound(POLL_INTERVAL_DELIVERY_WINDOW,
+        now.msecsTo(*predicted) + SCAN_LANDING_MARGIN, POLL_INTERVAL_FAR_FROM_ETA);
+    if (countSavings) scanModel.recordInterval(heuristic, modelInterval);
+    return modelInterval;
+}
+
+QDateTime PollScheduler::computeNextDue(const QString& trackingNumber, const PollState& state, const QDateTime& now,
+    double scale, bool countSavings)
+{
+    qint64 interval = intervalFor(state, now, countSavings);
+    if (interval < 0) return QDateTime();
+
+    if (interval != POLL_INTERVAL_DELIVERY_WINDOW) {
+        interval = static_cast<qint64>(interval * scale);
+    }
+
+    qint64 budgetInterval = budgetPlanner.minimumInterval(trackingNumber);
+    interval = qMax(interval, budgetInterval);
+
+    QDateTime next = now.addMSecs(interval + jitter(interval));
+
+    // Never sleep past the start of the delivery window, unless the budget forbids it
+    if (state.estimatedDelivery.isValid()) {
+        QDateTime windowStart = state.estimatedDelivery.addMSecs(-DELIVERY_WINDOW_MARGIN);
+        if (windowStart > now && windowStart < next && now.msecsTo(windowStart) >= budgetInterval) {
+            next = windowStart;
+        }
+    }
+
+    return next;
+}
+
+double PollScheduler::informationGain(const PollState& state, const QDateTime& now) const
+{
+    if (isTerminalStatus(state.status)) return 0;
+
+    double gain = 1.0;
+    if (state.substatus == "OUT_FOR_DELIVERY" || state.substatus == "DELIVERY_ATTEMPTED") {
+        gain = 8.0;
+    } else if (state.estimatedDelivery.isValid()) {
+        qint64 msToEta = now.msecsTo(state.estimatedDelivery);
+        if (qAbs(msToEta) <= DELIVERY_WINDOW_MARGIN) gain = 8.0;
+        else if (msToEta < 0) gain = 3.0;
+        else if (msToEta <= NEAR_ETA_HORIZON) gain = 4.0;
+        else gain = 0.5;
+    }
+
+    // Stale packages become more valuable to poll, up to double after a day
+    if (state.lastSuccessfulPoll.isValid()) {
+        double staleDays = static_cast<double>(state.lastSuccessfulPoll.msecsTo(now)) / MS_PER_DAY;
+        gain *= 1.0 + qBound(0.0, staleDays, 1.0);
+    } else {
+        gain *= 2.0;
+    }
+
+    return gain;
+}
+
+qint64 PollScheduler::jitter(qint64 interval) const
+{
+    qint64 spread = static_cast<qint64>(interval * POLL_JITTER_FRACTION);
+    if (spread <= 0) return 0;
+    return QRandomGenerator::global()->bounded(2 * spread + 1) - spread;
+}
+
+QList<QDateTime> PollScheduler::eventTimes(const QJsonObject& info)
+{
+    QList<QDateTime> times;
+    for (const auto& event : info["events"].toArray()) {
+        QDateTime eventTime = parseTimestamp(event.toObject()["timestamp"].toString());
+        if (eventTime.isValid()) times.append(eventTime);
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
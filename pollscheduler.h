@@ -0,0 +1,121 @@
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QDataStream>
+#include "scanintervalmodel.h"
+#include "budgetplanner.h"
+
+// Polling intervals used around the estimated delivery window
+constexpr qint64 POLL_INTERVAL_DELIVERY_WINDOW = 10 * 60 * 1000;   // 10 minutes
+constexpr qint64 POLL_INTERVAL_NEAR_ETA = 60 * 60 * 1000;          // 1 hour
+constexpr qint64 POLL_INTERVAL_FAR_FROM_ETA = 6 * 60 * 60 * 1000;  // 6 hours
+constexpr qint64 POLL_INTERVAL_OVERDUE = 30 * 60 * 1000;           // 30 minutes
+constexpr qint64 POLL_INTERVAL_QUIET = 2 * 60 * 60 * 1000;         // 2 hours
+constexpr qint64 DELIVERY_WINDOW_MARGIN = 12 * 60 * 60 * 1000;     // +/- 12 hours around ETA
+constexpr qint64 NEAR_ETA_HORIZON = 2 * 24 * 60 * 60 * 1000;       // 2 days
+constexpr qint64 SCAN_LANDING_MARGIN = 5 * 60 * 1000;              // poll 5 minutes after a predicted scan
+constexpr double POLL_JITTER_FRACTION = 0.1;                       // +/- 10% random jitter per poll
+constexpr int SCHEDULER_TICK_INTERVAL = 60 * 1000;                 // 1 minute
+constexpr qint64 BUDGET_REPLAN_INTERVAL = 60 * 60 * 1000;          // re-plan the budget hourly
+
+// Header of the saved schedule snapshot (see MainWindow::scheduleSnapshot)
+constexpr quint32 SCHEDULE_MAGIC = 0x50545031; // "PTP1"
+constexpr quint16 SCHEDULE_VERSION = 1;
+
+// Decides when each tracked package is next due for an API poll.
+// Packages far from their ETA are polled sparsely, packages inside the
+// delivery window (or out for delivery) are polled densely, and packages
+// in a terminal state are not polled at all. Once enough scans have been
+// observed for a carrier or lane, polls are timed to land just after the
+// next predicted scan instead.
+//
+// Each package gets a stable phase offset within the base interval and
+// every computed due time is jittered, so polls are spread evenly rather
+// than firing for every package at once.
+//
+// When a daily request budget is set, no package is polled more often than
+// its share of the budget allows, and automatic polling stops for the day
+// once the budget is spent.
+class PollScheduler
+{
+public:
+    struct PollState {
+        QString status = "UNKNOWN";
+        QString substatus;
+        QString carrier;
+        QString lane;
+        QDateTime estimatedDelivery;
+        QDateTime lastEventTime;
+        QDateTime lastSuccessfulPoll;
+        QDateTime nextDue;
+        bool scheduledInBackground = false;
+        bool eventsSeeded = false; // lastEventTime accounts for the stored history
+    };
+
+    explicit PollScheduler(qint64 baseIntervalMs);
+
+    void track(const QString& trackingNumber, const QDateTime& now);
+    void untrack(const QString& trackingNumber);
+    bool isTracked(const QString& trackingNumber) const;
+
+    void recordResult(const QString& trackingNumber, const QJsonObject& info, const QDateTime& now);
+    void recordFailure(const QString& trackingNumber, const QDateTime& now);
+    void recordAttempt(const QString& trackingNumber, const QDateTime& now);
+
+    // A package tracked afresh (unarchived, or without a saved schedule) has
+    // had its stored scans fed to the interval model before; seeding marks
+    // them as seen so only newer scans count
+    bool needsEventSeed(const QString& trackingNumber) const;
+    void seedEvents(const QString& trackingNumber, const QJsonObject& storedResult);
+
+    QStringList duePackages(const QDateTime& now) const;
+    QDateTime nextDue(const QString& trackingNumber) const;
+    const QHash<QString, PollState>& pollStates() const { return states; }
+
+    // Background mode stretches every interval outside the delivery window
+    void setIntervalScale(double scale) { intervalScale = scale; }
+    void catchUp(const QDateTime& now);
+
+    // Warm restart: per-package schedules written at exit and restored for
+    // packages that are tracked again, so only overdue ones are polled
+    void saveState(QDataStream& out) const;
+    bool restoreState(QDataStream& in);
+
+    void replanBudget(const QDateTime& now);
+    void replanBudgetIfNeeded(const QDateTime& now);
+    BudgetPlanner& budget() { return budgetPlanner; }
+    const BudgetPlanner& budget() const { return budgetPlanner; }
+
+    ScanIntervalModel& intervalModel() { return scanModel; }
+    const ScanIntervalModel& intervalModel() const { return scanModel; }
+
+    qint64 phaseOffset(const QString& trackingNumber) const;
+
+    static bool isTerminalStatus(const QString& status);
+    static QDateTime parseTimestamp(const QString& value);
+
+private:
+    qint64 heuristicInterval(const PollState& state, const QDateTime& now) const;
+    // countSavings is false when re-planning a poll that was already counted
+    qint64 intervalFor(const PollState& state, const QDateTime& now, bool countSavings);
+    QDateTime computeNextDue(const QString& trackingNumber, const PollState& state, const QDateTime& now,
+        double scale, bool countSavings = true);
+    double informationGain(const PollState& state, const QDateTime& now) const;
+    qint64 jitter(qint64 interval) const;
+    static QList<QDateTime> eventTimes(const QJsonObject& info);
+
+    qint64 baseIntervalMs;
+    QHash<QString, PollState> states;
+    ScanIntervalModel scanModel;
+    BudgetPlanner budgetPlanner;
+    double intervalScale = 1.0;
+    bool budgetDirty = true;
+    QDateTime lastBudgetPlan;
+};
+
+#endif // POLLSCHEDULER_H
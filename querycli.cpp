@@ -0,0 +1,79 @@
+#include "querycli.h"
+#include "packagequery.h"
+#include "persistenceworker.h"
+#include "pollscheduler.h"
+#include <QDataStream>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTextStream>
+
+int runQueryCommand(const QString& expression)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QSettings settings;
+    PersistenceWorker worker(PersistenceWorker::storeFactory(dataDir, settings.value("storageBackend", "sqlite").toString()),
+        dataDir + "/archive.pack", dataDir + "/schedule.dat");
+    // Read-only, so it can run while the app has the store open
+    if (!QDir(dataDir).exists() || !worker.openReadOnly()) {
+        err << "Could not open the package store in " << dataDir << Qt::endl;
+        return 1;
+    }
+
+    // Same columns the main window sees
+    QDateTime now = QDateTime::currentDateTime();
+    PollScheduler scheduler(0);
+    SearchIndex index;
+    QHash<QString, PackageRecord> active;
+    for (const PackageRecord& record : worker.loadPackages()) {
+        if (record.archived) continue;
+        active.insert(record.trackingNumber, record);
+        index.setPackage(record.trackingNumber, record.note, record.carrier);
+        if (!record.locations.isEmpty()) {
+            index.setField(record.trackingNumber, SearchIndex::LocationsField, record.locations.join('\n'));
+        }
+        scheduler.track(record.trackingNumber, now);
+    }
+
+    QDataStream schedule(worker.loadSchedule());
+    schedule.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    schedule >> magic >> version;
+    if (magic == SCHEDULE_MAGIC && version == SCHEDULE_VERSION) {
+        scheduler.restoreState(schedule);
+    }
+
+    PackageQuery query = PackageQuery::parse(expression, now);
+    auto archive = [&worker](const QString& filter) { return worker.queryArchive(filter); };
+
+    const QHash<QString, PollScheduler::PollState>& states = scheduler.pollStates();
+    auto columnsOf = [&](const QString& trackingNumber) -> std::optional<PackageColumns> {
+        auto it = active.constFind(trackingNumber);
+        if (it == active.cend()) return std::nullopt;
+        PackageColumns columns;
+        columns.trackingNumber = trackingNumber;
+        columns.status = it.value().status;
+        columns.carrier = it.value().carrier;
+        columns.note = it.value().note;
+        auto state = states.constFind(trackingNumber);
+        if (state != states.cend()) {
+            columns.eta = state.value().estimatedDelivery;
+            columns.lastUpdate = state.value().lastSuccessfulPoll;
+        }
+        columns.text = index.textOf(trackingNumber);
+        return columns;
+    };
+
+    for (const QueryMatch& match : query.run(index, columnsOf, archive)) {
+        const PackageColumns& columns = match.columns;
+        out << columns.trackingNumber << '\t' << columns.status << '\t' << columns.carrier << '\t'
+            << (columns.eta.isValid() ? columns.eta.toString(Qt::ISODate) : QString()) << '\t'
+            << columns.note << '\t' << (columns.archived ? "archived" : "") << '\n';
+    }
+    out.flush();
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef QUERYCLI_H
+#define QUERYCLI_H
+
+#include <QString>
+
+// Runs a PackageQuery against the stored packages without opening a window
+// and prints the matches, one per line, tab separated:
+//     tracking number, status, carrier, ETA, note, "archived" flag
+// Run with: PackageTracker --query 'status:TRANSIT eta<2d sort:eta'
+int runQueryCommand(const QString& expression);
+
+#endif // QUERYCLI_H
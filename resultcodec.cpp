@@ -0,0 +1,145 @@
+#include "resultcodec.h"
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+
+namespace {
+
+// Schema v1: a field's CBOR key is its index here. Only ever append.
+const char* const RESULT_FIELDS[] = {
+    "tracking_number", "carrier", "status", "substatus",
+    "estimatedDelivery", "service", "fromLocation", "toLocation"
+};
+const char* const EVENT_FIELDS[] = {
+    "id", "timestamp", "status", "substatus", "description", "location"
+};
+constexpr qint64 RESULT_EVENTS_KEY = 100;
+
+template <size_t N>
+QCborMap encodeFields(const QJsonObject& object, const char* const (&fields)[N])
+{
+    QCborMap map;
+    for (size_t i = 0; i < N; ++i) {
+        auto it = object.constFind(QLatin1String(fields[i]));
+        if (it != object.constEnd()) {
+            map.insert(qint64(i), it->toString());
+        }
+    }
+    return map;
+}
+
+template <size_t N>
+QJsonObject decodeFields(const QCborMap& map, const char* const (&fields)[N])
+{
+    QJsonObject object;
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        qint64 key = it.key().toInteger(-1);
+        if (key >= 0 && key < qint64(N)) {
+            object.insert(QLatin1String(fields[key]), it.value().toString());
+        }
+    }
+    return object;
+}
+
+template <size_t N>
+QJsonObject keepFields(const QJsonObject& object, const char* const (&fields)[N])
+{
+    QJsonObject kept;
+    for (const char* field : fields) {
+        auto it = object.constFind(QLatin1String(field));
+        if (it != object.constEnd()) {
+            kept.insert(it.key(), it.value());
+        }
+    }
+    return kept;
+}
+
+QByteArray wrap(const QCborMap& map)
+{
+    return QCborArray{ RESULT_SCHEMA_VERSION, map }.toCborValue().toCbor();
+}
+
+// Returns false for data that isn't a supported CBOR entry
+bool unwrap(const QByteArray& data, QCborMap& map)
+{
+    QCborValue value = QCborValue::fromCbor(data);
+    QCborArray entry = value.toArray();
+    if (entry.size() != 2 || !entry.at(1).isMap()) return false;
+
+    if (entry.at(0).toInteger() != RESULT_SCHEMA_VERSION) {
+        qDebug() << "Unsupported cached result schema" << entry.at(0).toInteger();
+        return false;
+    }
+    map = entry.at(1).toMap();
+    return true;
+}
+
+bool isJsonText(const QByteArray& data)
+{
+    return data.startsWith('{');
+}
+
+} // namespace
+
+QJsonObject ResultCodec::normalized(const QJsonObject& result)
+{
+    QJsonObject normalized = keepFields(result, RESULT_FIELDS);
+    auto events = result.constFind(QLatin1String("events"));
+    if (events != result.constEnd()) {
+        QJsonArray kept;
+        for (const QJsonValue& event : events->toArray()) {
+            kept.append(keepFields(event.toObject(), EVENT_FIELDS));
+        }
+        normalized.insert(QLatin1String("events"), kept);
+    }
+    return normalized;
+}
+
+QByteArray ResultCodec::encodeResult(const QJsonObject& result)
+{
+    QCborMap map = encodeFields(result, RESULT_FIELDS);
+    auto events = result.constFind(QLatin1String("events"));
+    if (events != result.constEnd()) {
+        QCborArray encoded;
+        for (const QJsonValue& event : events->toArray()) {
+            encoded.append(encodeFields(event.toObject(), EVENT_FIELDS));
+        }
+        map.insert(RESULT_EVENTS_KEY, encoded);
+    }
+    return wrap(map);
+}
+
+QJsonObject ResultCodec::decodeResult(const QByteArray& data)
+{
+    if (isJsonText(data)) return QJsonDocument::fromJson(data).object();
+
+    QCborMap map;
+    if (!unwrap(data, map)) return QJsonObject();
+
+    QJsonObject result = decodeFields(map, RESULT_FIELDS);
+    if (map.contains(RESULT_EVENTS_KEY)) {
+        QJsonArray events;
+        for (const QCborValue& event : map.value(RESULT_EVENTS_KEY).toArray()) {
+            events.append(decodeFields(event.toMap(), EVENT_FIELDS));
+        }
+        result.insert(QLatin1String("events"), events);
+    }
+    return result;
+}
+
+QByteArray ResultCodec::encodeEvent(const QJsonObject& event)
+{
+    return wrap(encodeFields(event, EVENT_FIELDS));
+}
+
+QJsonObject ResultCodec::decodeEvent(const QByteArray& data)
+{
+    if (isJsonText(data)) return QJsonDocument::fromJson(data).object();
+
+    QCborMap map;
+    if (!unwrap(data, map)) return QJsonObject();
+    return decodeFields(map, EVENT_FIELDS);
+}
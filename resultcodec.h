@@ -0,0 +1,25 @@
+#ifndef RESULTCODEC_H
+#define RESULTCODEC_H
+
+#include <QByteArray>
+#include <QJsonObject>
+
+constexpr qint64 RESULT_SCHEMA_VERSION = 1;
+
+// Binary encoding for cached tracking results. Only the normalized fields
+// the app reads back (status, substatus, ETA, locations, events) are kept,
+// written as CBOR maps with small integer keys behind a schema version.
+// Decoding also accepts the JSON text older caches were written in.
+class ResultCodec
+{
+public:
+    static QJsonObject normalized(const QJsonObject& result);
+
+    static QByteArray encodeResult(const QJsonObject& result);
+    static QJsonObject decodeResult(const QByteArray& data);
+
+    static QByteArray encodeEvent(const QJsonObject& event);
+    static QJsonObject decodeEvent(const QByteArray& data);
+};
+
+#endif // RESULTCODEC_H
@@ -0,0 +1,103 @@
+#include "scanintervalmodel.h"
+#include <QtGlobal>
+
+void ScanIntervalModel::observeGap(const QString& carrier, const QString& lane, qint64 gapMs)
+{
+    if (carrier.isEmpty() || gapMs <= 0 || gapMs > SCAN_MODEL_MAX_GAP) return;
+
+    update(carrierStats[carrier], gapMs);
+    if (!lane.isEmpty()) {
+        update(laneStats[laneKey(carrier, lane)], gapMs);
+    }
+}
+
+std::optional<qint64> ScanIntervalModel::expectedGap(const QString& carrier, const QString& lane) const
+{
+    // Prefer the lane-specific estimate, fall back to the carrier-wide one
+    auto laneIt = laneStats.constFind(laneKey(carrier, lane));
+    if (!lane.isEmpty() && laneIt != laneStats.constEnd() && laneIt.value().samples >= SCAN_MODEL_MIN_SAMPLES) {
+        return static_cast<qint64>(laneIt.value().meanGapMs);
+    }
+
+    auto carrierIt = carrierStats.constFind(carrier);
+    if (carrierIt != carrierStats.constEnd() && carrierIt.value().samples >= SCAN_MODEL_MIN_SAMPLES) {
+        return static_cast<qint64>(carrierIt.value().meanGapMs);
+    }
+
+    return std::nullopt;
+}
+
+std::optional<QDateTime> ScanIntervalModel::predictNextScan(const QString& carrier, const QString& lane,
+    const QDateTime& lastEventTime) const
+{
+    if (!lastEventTime.isValid()) return std::nullopt;
+
+    auto gap = expectedGap(carrier, lane);
+    if (!gap) return std::nullopt;
+
+    return lastEventTime.addMSecs(*gap);
+}
+
+void ScanIntervalModel::recordInterval(qint64 heuristicMs, qint64 modelMs)
+{
+    if (heuristicMs <= 0 || modelMs <= 0) return;
+
+    // Over modelMs the heuristic would have polled modelMs / heuristicMs times; we poll once
+    savedPolls += static_cast<double>(modelMs) / heuristicMs - 1.0;
+}
+
+QVariantMap ScanIntervalModel::toVariant() const
+{
+    auto statsToVariant = [](const QHash<QString, GapStats>& source) {
+        QVariantMap map;
+        for (auto it = source.constBegin(); it != source.constEnd(); ++it) {
+            map[it.key()] = QVariantList{ it.value().meanGapMs, it.value().deviationMs, it.value().samples };
+        }
+        return map;
+    };
+
+    QVariantMap data;
+    data["carriers"] = statsToVariant(carrierStats);
+    data["lanes"] = statsToVariant(laneStats);
+    data["pollsSaved"] = savedPolls;
+    return data;
+}
+
+void ScanIntervalModel::fromVariant(const QVariantMap& data)
+{
+    auto variantToStats = [](const QVariantMap& source) {
+        QHash<QString, GapStats> stats;
+        for (auto it = source.constBegin(); it != source.constEnd(); ++it) {
+            QVariantList values = it.value().toList();
+            if (values.size() != 3) continue;
+            GapStats entry;
+            entry.meanGapMs = values[0].toDouble();
+            entry.deviationMs = values[1].toDouble();
+            entry.samples = values[2].toInt();
+            stats.insert(it.key(), entry);
+        }
+        return stats;
+    };
+
+    carrierStats = variantToStats(data["carriers"].toMap());
+    laneStats = variantToStats(data["lanes"].toMap());
+    savedPolls = data["pollsSaved"].toDouble();
+}
+
+QString ScanIntervalModel::laneKey(const QString& carrier, const QString& lane)
+{
+    return carrier + "|" + lane;
+}
+
+void ScanIntervalModel::update(GapStats& stats, qint64 gapMs)
+{
+    if (stats.samples == 0) {
+        stats.meanGapMs = gapMs;
+        stats.deviationMs = 0;
+    } else {
+        double error = gapMs - stats.meanGapMs;
+        stats.meanGapMs += SCAN_MODEL_SMOOTHING * error;
+        stats.deviationMs += SCAN_MODEL_SMOOTHING * (qAbs(error) - stats.deviationMs);
+    }
+    stats.samples++;
+}
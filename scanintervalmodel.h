@@ -0,0 +1,50 @@
+#ifndef SCANINTERVALMODEL_H
+#define SCANINTERVALMODEL_H
+
+#include <QString>
+#include <QHash>
+#include <QVariantMap>
+#include <QDateTime>
+#include <optional>
+
+constexpr int SCAN_MODEL_MIN_SAMPLES = 3;
+constexpr double SCAN_MODEL_SMOOTHING = 0.2;
+constexpr qint64 SCAN_MODEL_MAX_GAP = 7LL * 24 * 60 * 60 * 1000; // ignore gaps over a week
+
+// Online model of how often carriers publish new scan events. Gaps between
+// consecutive tracking events are smoothed per carrier and per lane
+// (carrier + origin state + destination state) so the scheduler can time a
+// poll to land just after the next scan is likely to appear.
+class ScanIntervalModel
+{
+public:
+    struct GapStats {
+        double meanGapMs = 0;
+        double deviationMs = 0;
+        int samples = 0;
+    };
+
+    void observeGap(const QString& carrier, const QString& lane, qint64 gapMs);
+    std::optional<qint64> expectedGap(const QString& carrier, const QString& lane) const;
+    std::optional<QDateTime> predictNextScan(const QString& carrier, const QString& lane,
+        const QDateTime& lastEventTime) const;
+
+    // Fractional polls avoided (or added, when negative) compared to the
+    // heuristic interval the scheduler would otherwise have used.
+    void recordInterval(qint64 heuristicMs, qint64 modelMs);
+    double pollsSaved() const { return savedPolls; }
+
+    QVariantMap toVariant() const;
+    void fromVariant(const QVariantMap& data);
+
+    static QString laneKey(const QString& carrier, const QString& lane);
+
+private:
+    static void update(GapStats& stats, qint64 gapMs);
+
+    QHash<QString, GapStats> carrierStats;
+    QHash<QString, GapStats> laneStats;
+    double savedPolls = 0;
+};
+
+#endif // SCANINTERVALMODEL_H
@@ -0,0 +1,228 @@
+#include "searchindex.h"
+#include <QBitArray>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const QChar FIELD_SEPARATOR = QChar(0x1f);
+
+} // namespace
+
+void SearchIndex::setField(const QString& trackingNumber, Field field, const QString& value)
+{
+    quint32 id = documentId(trackingNumber);
+    Document& document = documents[id];
+    if (document.fields[field] == value && !document.text.isEmpty()) return;
+
+    QString previous = document.text;
+    document.fields[field] = value;
+    reindex(id, previous);
+}
+
+void SearchIndex::setPackage(const QString& trackingNumber, const QString& note, const QString& carrier)
+{
+    quint32 id = documentId(trackingNumber);
+    Document& document = documents[id];
+    QString previous = document.text;
+    document.fields[TrackingNumberField] = trackingNumber;
+    document.fields[NoteField] = note;
+    document.fields[CarrierField] = carrier;
+    reindex(id, previous);
+}
+
+void SearchIndex::removeDocument(const QString& trackingNumber)
+{
+    auto it = docIds.find(trackingNumber);
+    if (it == docIds.end()) return;
+
+    quint32 id = it.value();
+    docIds.erase(it);
+    removePostings(id, trigrams(documents.at(id).text));
+    documents[id] = Document();
+    freeIds.append(id);
+}
+
+void SearchIndex::clear()
+{
+    docIds.clear();
+    documents.clear();
+    freeIds.clear();
+    postings.clear();
+}
+
+QList<SearchIndex::Match> SearchIndex::search(const QString& query) const
+{
+    QString needle = query.toLower();
+    QList<Match> matches;
+
+    if (needle.size() < SEARCH_GRAM_SIZE) {
+        // Every occurrence sits inside a trigram, so no verification is needed
+        QBitArray seen(documents.size());
+        for (auto posting = postings.constBegin(); posting != postings.constEnd(); ++posting) {
+            if (!gramContains(posting.key(), needle)) continue;
+            for (quint32 id : posting.value()) {
+                if (seen.testBit(id)) continue;
+                seen.setBit(id);
+                const Document& document = documents.at(id);
+                matches.append({ document.trackingNumber, rankDocument(document, needle) });
+            }
+        }
+        return matches;
+    }
+
+    QVector<const QVector<quint32>*> lists;
+    for (quint64 gram : trigrams(needle)) {
+        auto posting = postings.constFind(gram);
+        if (posting == postings.constEnd()) return matches;
+        lists.append(&posting.value());
+    }
+    std::sort(lists.begin(), lists.end(),
+        [](const QVector<quint32>* a, const QVector<quint32>* b) { return a->size() < b->size(); });
+
+    // Intersect smallest first; later lists are only probed by binary search
+    QVector<quint32> candidates = *lists.first();
+    for (qsizetype i = 1; i < lists.size() && !candidates.isEmpty(); ++i) {
+        const QVector<quint32>& list = *lists.at(i);
+        auto from = list.cbegin();
+        auto kept = candidates.begin();
+        for (quint32 id : std::as_const(candidates)) {
+            from = std::lower_bound(from, list.cend(), id);
+            if (from == list.cend()) break;
+            if (*from == id) *kept++ = id;
+        }
+        candidates.erase(kept, candidates.end());
+    }
+
+    // Trigrams can all be present without being adjacent
+    for (quint32 id : std::as_const(candidates)) {
+        const Document& document = documents.at(id);
+        MatchRank rank = rankDocument(document, needle);
+        if (rank != NoMatch) matches.append({ document.trackingNumber, rank });
+    }
+    return matches;
+}
+
+QString SearchIndex::textOf(const QString& trackingNumber) const
+{
+    auto it = docIds.constFind(trackingNumber);
+    return it == docIds.constEnd() ? QString() : documents.at(it.value()).text;
+}
+
+QString SearchIndex::field(const QString& trackingNumber, Field field) const
+{
+    auto it = docIds.constFind(trackingNumber);
+    return it == docIds.constEnd() ? QString() : documents.at(it.value()).fields[field];
+}
+
+SearchIndex::MatchRank SearchIndex::rankMatch(const QString& trackingNumber, const QString& note,
+    const QString& needle)
+{
+    QString number = trackingNumber.toLower();
+    if (number == needle) return ExactMatch;
+    if (number.startsWith(needle)) return PrefixMatch;
+    if (number.contains(needle)) return TrackingNumberMatch;
+    if (note.toLower().contains(needle)) return NoteMatch;
+    return NoMatch;
+}
+
+SearchIndex::MatchRank SearchIndex::rankDocument(const Document& document, const QString& needle)
+{
+    if (!document.text.contains(needle)) return NoMatch;
+    MatchRank rank = rankMatch(document.fields[TrackingNumberField], document.fields[NoteField], needle);
+    return rank == NoMatch ? OtherMatch : rank;
+}
+
+quint32 SearchIndex::documentId(const QString& trackingNumber)
+{
+    auto existing = docIds.constFind(trackingNumber);
+    if (existing != docIds.constEnd()) return existing.value();
+
+    quint32 id;
+    if (!freeIds.isEmpty()) {
+        id = freeIds.takeLast();
+    } else {
+        id = quint32(documents.size());
+        documents.append(Document());
+    }
+    docIds.insert(trackingNumber, id);
+    documents[id].trackingNumber = trackingNumber;
+    documents[id].fields[TrackingNumberField] = trackingNumber;
+    return id;
+}
+
+void SearchIndex::reindex(quint32 id, const QString& previousText)
+{
+    Document& document = documents[id];
+    document.text = documentText(document);
+    if (document.text == previousText) return;
+
+    // Both lists are sorted and unique; only the difference touches postings
+    QVector<quint64> before = trigrams(previousText);
+    QVector<quint64> after = trigrams(document.text);
+    QVector<quint64> lost, gained;
+    std::set_difference(before.cbegin(), before.cend(), after.cbegin(), after.cend(), std::back_inserter(lost));
+    std::set_difference(after.cbegin(), after.cend(), before.cbegin(), before.cend(), std::back_inserter(gained));
+    removePostings(id, lost);
+    addPostings(id, gained);
+}
+
+QString SearchIndex::documentText(const Document& document)
+{
+    QString text;
+    for (const QString& field : document.fields) {
+        if (!text.isEmpty()) text += FIELD_SEPARATOR;
+        text += field.toLower();
+    }
+    return text;
+}
+
+QVector<quint64> SearchIndex::trigrams(const QString& text)
+{
+    QVector<quint64> grams;
+    if (text.size() < SEARCH_GRAM_SIZE) return grams;
+
+    grams.reserve(text.size() - SEARCH_GRAM_SIZE + 1);
+    for (qsizetype i = 0; i + SEARCH_GRAM_SIZE <= text.size(); ++i) {
+        grams.append(trigramKey(text.constData() + i));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+quint64 SearchIndex::trigramKey(const QChar* chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | chars[2].unicode();
+}
+
+bool SearchIndex::gramContains(quint64 gram, const QString& needle)
+{
+    const QChar chars[SEARCH_GRAM_SIZE] = { QChar(ushort(gram >> 32)), QChar(ushort(gram >> 16)), QChar(ushort(gram)) };
+    return QStringView(chars, SEARCH_GRAM_SIZE).contains(needle);
+}
+
+void SearchIndex::addPostings(quint32 id, const QVector<quint64>& grams)
+{
+    for (quint64 gram : grams) {
+        QVector<quint32>& list = postings[gram];
+        // Ids are mostly handed out in increasing order, so this is usually an append
+        if (list.isEmpty() || list.last() < id) {
+            list.append(id);
+        } else {
+            list.insert(std::lower_bound(list.begin(), list.end(), id), id);
+        }
+    }
+}
+
+void SearchIndex::removePostings(quint32 id, const QVector<quint64>& grams)
+{
+    for (quint64 gram : grams) {
+        auto posting = postings.find(gram);
+        if (posting == postings.end()) continue;
+        QVector<quint32>& list = posting.value();
+        auto it = std::lower_bound(list.begin(), list.end(), id);
+        if (it != list.end() && *it == id) list.erase(it);
+        if (list.isEmpty()) postings.erase(posting);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <array>
+
+constexpr int SEARCH_GRAM_SIZE = 3;
+
+// Trigram inverted index over the searchable text of active packages:
+// tracking number, note, carrier and the locations in their event history.
+// Each package is a document with a dense id; every trigram of its
+// lowercased text has a posting list of document ids kept sorted. A
+// substring query intersects the posting lists of its own trigrams,
+// smallest first, and only the surviving candidates are checked with a
+// real substring match. A query shorter than a trigram takes the union of
+// the posting lists whose trigram contains it; fields are joined with
+// separators, so every document has trigrams and none is missed.
+// Matches are ranked by where the query was found, best first.
+//
+// Documents are updated field by field, and only the trigrams that were
+// gained or lost are touched, so edits and new tracking results are cheap.
+class SearchIndex
+{
+public:
+    enum Field {
+        TrackingNumberField,
+        NoteField,
+        CarrierField,
+        LocationsField,
+        FieldCount
+    };
+
+    // Lower is more relevant
+    enum MatchRank {
+        ExactMatch,          // the tracking number is the query
+        PrefixMatch,         // the tracking number starts with the query
+        TrackingNumberMatch, // the tracking number contains the query
+        NoteMatch,
+        OtherMatch,          // carrier or event location
+        NoMatch
+    };
+
+    struct Match {
+        QString trackingNumber;
+        MatchRank rank;
+    };
+
+    void setField(const QString& trackingNumber, Field field, const QString& value);
+    void setPackage(const QString& trackingNumber, const QString& note, const QString& carrier);
+    void removeDocument(const QString& trackingNumber);
+    void clear();
+
+    // Packages whose indexed text contains query (case-insensitive), unordered
+    QList<Match> search(const QString& query) const;
+    static MatchRank rankMatch(const QString& trackingNumber, const QString& note, const QString& needle);
+    int size() const { return docIds.size(); }
+    QStringList trackingNumbers() const { return docIds.keys(); }
+    QString textOf(const QString& trackingNumber) const; // lowercased indexed text
+    QString field(const QString& trackingNumber, Field field) const;
+
+private:
+    struct Document {
+        QString trackingNumber;
+        std::array<QString, FieldCount> fields;
+        QString text; // lowercased fields, separated so no trigram spans two of them
+    };
+
+    quint32 documentId(const QString& trackingNumber);
+    void reindex(quint32 id, const QString& previousText);
+    static MatchRank rankDocument(const Document& document, const QString& needle);
+    static QString documentText(const Document& document);
+    static QVector<quint64> trigrams(const QString& text);
+    static quint64 trigramKey(const QChar* chars);
+    static bool gramContains(quint64 gram, const QString& needle);
+    void addPostings(quint32 id, const QVector<quint64>& grams);
+    void removePostings(quint32 id, const QVector<quint64>& grams);
+
+    QHash<QString, quint32> docIds;
+    QList<Document> documents;
+    QList<quint32> freeIds;
+    QHash<quint64, QVector<quint32>> postings;
+};
+
+#endif // SEARCHINDEX_H
@@ -19,14 +19,27 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     shippoTokenInput = new QLineEdit(this);
     webhookUrlInput = new QLineEdit(this);
     darkModeCheckbox = new QCheckBox("Dark Mode", this);
+    dailyBudgetInput = new QSpinBox(this);
+    dailyBudgetInput->setRange(0, 1000000);
+    dailyBudgetInput->setSpecialValueText("Unlimited");
+    budgetUsageLabel = new QLabel(this);
+    autoArchiveDaysInput = new QSpinBox(this);
+    autoArchiveDaysInput->setRange(0, 365);
+    autoArchiveDaysInput->setSpecialValueText("Never");
+    autoArchiveDaysInput->setSuffix(" days");
     
     // Set object names for styling
     shippoTokenInput->setObjectName("settingsInput");
     webhookUrlInput->setObjectName("settingsInput");
     darkModeCheckbox->setObjectName("settingsCheckbox");
+    dailyBudgetInput->setObjectName("settingsInput");
+    autoArchiveDaysInput->setObjectName("settingsInput");
     
     formLayout->addRow("Shippo API Token:", shippoTokenInput);
     formLayout->addRow("Webhook URL:", webhookUrlInput);
+    formLayout->addRow("Daily Request Budget:", dailyBudgetInput);
+    formLayout->addRow(budgetUsageLabel);
+    formLayout->addRow("Auto-archive Delivered After:", autoArchiveDaysInput);
     formLayout->addRow(darkModeCheckbox);
     
     saveButton = new QPushButton("Save", this);
@@ -36,6 +49,7 @@ SettingsDialog::SettingsDialog(QWidget *parent)
         QString shippoToken = shippoTokenInput->text().trimmed();
         QString webhookUrl = webhookUrlInput->text().trimmed();
         bool darkMode = darkModeCheckbox->isChecked();
+        int dailyBudget = dailyBudgetInput->value();
         
         if (shippoToken.isEmpty()) {
             QMessageBox::warning(this, "Invalid Credentials", 
@@ -47,10 +61,13 @@ SettingsDialog::SettingsDialog(QWidget *parent)
         settings.setValue("shippoToken", shippoToken);
         settings.setValue("webhookUrl", webhookUrl);
         settings.setValue("darkMode", darkMode);
+        settings.setValue("dailyRequestBudget", dailyBudget);
+        settings.setValue("autoArchiveDays", autoArchiveDaysInput->value());
 
         // Update client with new credentials
         MainWindow* mainWindow = qobject_cast<MainWindow*>(parent);
         if (mainWindow) {
+            mainWindow->setDailyRequestBudget(dailyBudget);
             mainWindow->updateApiClients(shippoToken);
             mainWindow->applyTheme(darkMode);
         }
@@ -63,6 +80,12 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     shippoTokenInput->setText(settings.value("shippoToken").toString());
     webhookUrlInput->setText(settings.value("webhookUrl").toString());
     darkModeCheckbox->setChecked(settings.value("darkMode", false).toBool());
+    dailyBudgetInput->setValue(settings.value("dailyRequestBudget", DEFAULT_DAILY_REQUEST_BUDGET).toInt());
+    autoArchiveDaysInput->setValue(settings.value("autoArchiveDays", DEFAULT_AUTO_ARCHIVE_DAYS).toInt());
+    
+    if (MainWindow* mainWindow = qobject_cast<MainWindow*>(parent)) {
+        budgetUsageLabel->setText(mainWindow->budgetSummary());
+    }
     
     mainLayout->addLayout(formLayout);
     mainLayout->addWidget(saveButton);
@@ -79,7 +102,7 @@ void SettingsDialog::updateTheme(bool darkMode)
             background-color: white;
             color: #333333;
         }
-        QLineEdit#settingsInput {
+        QLineEdit#settingsInput, QSpinBox#settingsInput {
             background-color: white;
             color: #333333;
             border: 1px solid rgba(0, 0, 0, 0.15);
@@ -131,7 +154,7 @@ void SettingsDialog::updateTheme(bool darkMode)
             background-color: #1e1e1e;
             color: #ffffff;
         }
-        QLineEdit#settingsInput {
+        QLineEdit#settingsInput, QSpinBox#settingsInput {
             background-color: #2d2d2d;
             color: #ffffff;
             border: 1px solid rgba(255, 255, 255, 0.15);
@@ -5,6 +5,8 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QPushButton>
+#include <QSpinBox>
+#include <QLabel>
 
 class SettingsDialog : public QDialog
 {
@@ -15,6 +17,8 @@ public:
     QLineEdit* shippoTokenInput;
     QLineEdit* webhookUrlInput;
     QCheckBox* darkModeCheckbox;
+    QSpinBox* dailyBudgetInput;
+    QSpinBox* autoArchiveDaysInput;
     
     // Add method to update theme
     void updateTheme(bool darkMode);
@@ -22,6 +26,7 @@ public:
 private:
     void setupUI();
     QPushButton* saveButton;  // Add this to access the save button for theming
+    QLabel* budgetUsageLabel;
 };
 
 #endif // SETTINGSDIALOG_H
@@ -5,6 +5,7 @@
 #include <QNetworkRequest>
 #include <QUrl>
 #include <QDateTime>
+#include "packagestore.h"
 
 QString ShippoClient::detectCarrier(const QString& trackingNumber) {
     // Simple pattern matching for common carriers
@@ -210,6 +211,10 @@ void ShippoClient::onRequestFinished(QNetworkReply* reply)
             eventObj["substatus"] = trackEvent["substatus"].toString();
         }
         
+        // Stable identity so stores only append events they haven't seen
+        QString objectId = trackEvent["object_id"].toString();
+        eventObj["id"] = objectId.isEmpty() ? trackingEventId(eventObj) : objectId;
+        
         events.append(eventObj);
     }
     result["events"] = events;
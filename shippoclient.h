@@ -61,6 +61,7 @@ public:
     explicit ShippoClient(const QString& apiToken, QObject *parent = nullptr);
     void trackPackage(const QString& trackingNumber);
     void handleWebhookEvent(const QJsonObject& webhookData);
+    static QString detectCarrier(const QString& trackingNumber);
     
 signals:
     void trackingInfoReceived(const QJsonObject& info);
@@ -71,7 +72,6 @@ private slots:
     void onRequestFinished(QNetworkReply* reply);
     
 private:
-    QString detectCarrier(const QString& trackingNumber);
     QNetworkAccessManager* manager;
     QString apiToken;
 };
@@ -0,0 +1,276 @@
+#include "sqlitepackagestore.h"
+#include "resultcodec.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QJsonArray>
+#include <QVariant>
+#include <QFile>
+#include <QDebug>
+
+SqlitePackageStore::SqlitePackageStore(const QString& databasePath)
+    : databasePath(databasePath),
+      connectionName(QString("packages-%1").arg(reinterpret_cast<quintptr>(this)))
+{
+}
+
+SqlitePackageStore::~SqlitePackageStore()
+{
+    {
+        QSqlDatabase db = database();
+        if (db.isOpen()) db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+QSqlDatabase SqlitePackageStore::database() const
+{
+    return QSqlDatabase::database(connectionName, false);
+}
+
+bool SqlitePackageStore::open()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(databasePath);
+    if (!db.open()) {
+        qDebug() << "Failed to open package store:" << db.lastError().text();
+        return false;
+    }
+
+    static const QStringList schema = {
+        "PRAGMA journal_mode=WAL",
+        "PRAGMA synchronous=NORMAL",
+        "PRAGMA foreign_keys=ON",
+        "CREATE TABLE IF NOT EXISTS packages ("
+        "  tracking_number TEXT PRIMARY KEY,"
+        "  note TEXT NOT NULL DEFAULT '',"
+        "  status TEXT NOT NULL DEFAULT 'UNKNOWN',"
+        "  carrier TEXT NOT NULL DEFAULT '',"
+        "  archived INTEGER NOT NULL DEFAULT 0,"
+        "  terminal_since INTEGER,"
+        "  locations TEXT NOT NULL DEFAULT ''"
+        ")",
+        "CREATE TABLE IF NOT EXISTS results ("
+        "  tracking_number TEXT PRIMARY KEY REFERENCES packages(tracking_number) ON DELETE CASCADE,"
+        "  status TEXT,"
+        "  substatus TEXT,"
+        "  eta TEXT,"
+        "  details BLOB NOT NULL,"
+        "  updated_at INTEGER NOT NULL"
+        ")",
+        "CREATE TABLE IF NOT EXISTS events ("
+        "  tracking_number TEXT NOT NULL REFERENCES packages(tracking_number) ON DELETE CASCADE,"
+        "  event_id TEXT NOT NULL,"
+        "  position INTEGER NOT NULL,"
+        "  payload BLOB NOT NULL,"
+        "  UNIQUE (tracking_number, event_id)"
+        ")"
+    };
+
+    QSqlQuery query(db);
+    for (const QString& statement : schema) {
+        if (!query.exec(statement)) {
+            qDebug() << "Package store schema error:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqlitePackageStore::openReadOnly()
+{
+    if (!QFile::exists(databasePath)) {
+        qDebug() << "No package store at" << databasePath;
+        return false;
+    }
+
+    // SQLite itself rejects writes, and the schema is left as the app made it
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(databasePath);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!db.open()) {
+        qDebug() << "Failed to open package store:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqlitePackageStore::isEmpty()
+{
+    QSqlQuery query(database());
+    if (!query.exec("SELECT 1 FROM packages LIMIT 1")) return true;
+    return !query.next();
+}
+
+QList<PackageRecord> SqlitePackageStore::loadPackages()
+{
+    QList<PackageRecord> records;
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT tracking_number, note, status, carrier, archived, terminal_since, locations "
+                    "FROM packages")) {
+        qDebug() << "Failed to load packages:" << query.lastError().text();
+        return records;
+    }
+
+    while (query.next()) {
+        PackageRecord record;
+        record.trackingNumber = query.value(0).toString();
+        record.note = query.value(1).toString();
+        record.status = query.value(2).toString();
+        record.carrier = query.value(3).toString();
+        record.archived = query.value(4).toBool();
+        if (!query.value(5).isNull()) {
+            record.terminalSince = QDateTime::fromMSecsSinceEpoch(query.value(5).toLongLong());
+        }
+        record.locations = query.value(6).toString().split('\n', Qt::SkipEmptyParts);
+        records.append(record);
+    }
+    return records;
+}
+
+QJsonObject SqlitePackageStore::loadResult(const QString& trackingNumber)
+{
+    QSqlQuery query(database());
+    query.prepare("SELECT details FROM results WHERE tracking_number = ?");
+    query.addBindValue(trackingNumber);
+    if (!query.exec()) {
+        qDebug() << "Failed to load cached result:" << query.lastError().text();
+        return QJsonObject();
+    }
+    if (!query.next()) return QJsonObject();
+    QJsonObject result = ResultCodec::decodeResult(query.value(0).toByteArray());
+
+    // Results cached before events were split out still carry their own array
+    QSqlQuery events(database());
+    events.setForwardOnly(true);
+    events.prepare("SELECT payload FROM events WHERE tracking_number = ? ORDER BY position");
+    events.addBindValue(trackingNumber);
+    if (!events.exec()) {
+        qDebug() << "Failed to load tracking events:" << events.lastError().text();
+        return result;
+    }
+
+    QJsonArray history;
+    while (events.next()) {
+        history.append(ResultCodec::decodeEvent(events.value(0).toByteArray()));
+    }
+    if (!history.isEmpty()) {
+        result["events"] = history;
+    }
+    return result;
+}
+
+QSet<QString> SqlitePackageStore::loadEventIds(const QString& trackingNumber)
+{
+    QSet<QString> ids;
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT event_id FROM events WHERE tracking_number = ?");
+    query.addBindValue(trackingNumber);
+    if (!query.exec()) {
+        qDebug() << "Failed to load tracking event ids:" << query.lastError().text();
+        return ids;
+    }
+    while (query.next()) {
+        ids.insert(query.value(0).toString());
+    }
+    return ids;
+}
+
+bool SqlitePackageStore::apply(const PackageChangeSet& changes)
+{
+    if (changes.isEmpty()) return true;
+
+    QSqlDatabase db = database();
+    if (!db.transaction()) {
+        qDebug() << "Failed to start transaction:" << db.lastError().text();
+        return false;
+    }
+
+    auto fail = [&db](const QSqlQuery& query) {
+        qDebug() << "Package store write failed:" << query.lastError().text();
+        db.rollback();
+        return false;
+    };
+
+    // Removals go first so a package added back in the same batch starts
+    // fresh; cached results and events go away via ON DELETE CASCADE
+    QSqlQuery remove(db);
+    remove.prepare("DELETE FROM packages WHERE tracking_number = ?");
+    for (const QString& trackingNumber : changes.removals) {
+        remove.addBindValue(trackingNumber);
+        if (!remove.exec()) return fail(remove);
+    }
+
+    QSqlQuery upsert(db);
+    upsert.prepare(
+        "INSERT INTO packages (tracking_number, note, status, carrier, archived, terminal_since) "
+        "VALUES (?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(tracking_number) DO UPDATE SET "
+        "  note = excluded.note, status = excluded.status, carrier = excluded.carrier, "
+        "  archived = excluded.archived, terminal_since = excluded.terminal_since");
+    for (const auto& record : changes.upserts) {
+        upsert.addBindValue(record.trackingNumber);
+        upsert.addBindValue(record.note);
+        upsert.addBindValue(record.status);
+        upsert.addBindValue(record.carrier);
+        upsert.addBindValue(record.archived ? 1 : 0);
+        upsert.addBindValue(record.terminalSince.isValid()
+            ? QVariant(record.terminalSince.toMSecsSinceEpoch()) : QVariant());
+        if (!upsert.exec()) return fail(upsert);
+    }
+
+    const QSet<QString> dropped = changes.droppedPackages();
+    QSqlQuery locations(db);
+    locations.prepare("UPDATE packages SET locations = ? WHERE tracking_number = ?");
+    for (auto it = changes.locations.constBegin(); it != changes.locations.constEnd(); ++it) {
+        if (dropped.contains(it.key())) continue;
+        locations.addBindValue(it.value().join('\n'));
+        locations.addBindValue(it.key());
+        if (!locations.exec()) return fail(locations);
+    }
+
+    QSqlQuery result(db);
+    result.prepare(
+        "INSERT INTO results (tracking_number, status, substatus, eta, details, updated_at) "
+        "VALUES (?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(tracking_number) DO UPDATE SET "
+        "  status = excluded.status, substatus = excluded.substatus, eta = excluded.eta, "
+        "  details = excluded.details, updated_at = excluded.updated_at");
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = changes.results.constBegin(); it != changes.results.constEnd(); ++it) {
+        if (dropped.contains(it.key())) continue;
+        const QJsonObject& info = it.value();
+        result.addBindValue(it.key());
+        result.addBindValue(info["status"].toString());
+        result.addBindValue(info["substatus"].toString());
+        result.addBindValue(info["estimatedDelivery"].toString());
+        result.addBindValue(ResultCodec::encodeResult(info));
+        result.addBindValue(now);
+        if (!result.exec()) return fail(result);
+    }
+
+    // Events are only ever appended; one already stored is left untouched
+    QSqlQuery event(db);
+    event.prepare(
+        "INSERT OR IGNORE INTO events (tracking_number, event_id, position, payload) "
+        "VALUES (?, ?, (SELECT COALESCE(MAX(position) + 1, 0) FROM events WHERE tracking_number = ?), ?)");
+    for (auto it = changes.newEvents.constBegin(); it != changes.newEvents.constEnd(); ++it) {
+        if (dropped.contains(it.key())) continue;
+        for (const QJsonValue& value : it.value()) {
+            QJsonObject info = value.toObject();
+            event.addBindValue(it.key());
+            event.addBindValue(trackingEventId(info));
+            event.addBindValue(it.key());
+            event.addBindValue(ResultCodec::encodeEvent(info));
+            if (!event.exec()) return fail(event);
+        }
+    }
+
+    if (!db.commit()) {
+        qDebug() << "Failed to commit package store changes:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef SQLITEPACKAGESTORE_H
+#define SQLITEPACKAGESTORE_H
+
+#include <QSqlDatabase>
+#include "packagestore.h"
+
+// SQLite-backed package store running in WAL mode. Packages (with their
+// notes and archive flags) live in one table, cached tracking results in
+// another and their event histories in a third; every change is an upsert
+// of the affected rows only, and events are inserted once and never rewritten.
+class SqlitePackageStore : public PackageStore
+{
+public:
+    explicit SqlitePackageStore(const QString& databasePath);
+    ~SqlitePackageStore() override;
+
+    bool open() override;
+    bool openReadOnly() override;
+    bool isEmpty() override;
+    QList<PackageRecord> loadPackages() override;
+    QJsonObject loadResult(const QString& trackingNumber) override;
+    QSet<QString> loadEventIds(const QString& trackingNumber) override;
+    bool apply(const PackageChangeSet& changes) override;
+
+private:
+    QSqlDatabase database() const;
+
+    QString databasePath;
+    QString connectionName;
+};
+
+#endif // SQLITEPACKAGESTORE_H
@@ -0,0 +1,32 @@
+#include "startuptimeline.h"
+#include <QDebug>
+
+QElapsedTimer StartupTimeline::clock;
+QList<QPair<const char*, qint64>> StartupTimeline::stages;
+bool StartupTimeline::finished = false;
+
+void StartupTimeline::start()
+{
+    clock.start();
+}
+
+void StartupTimeline::mark(const char* stage)
+{
+    if (finished || !clock.isValid()) return;
+    stages.append({ stage, clock.elapsed() });
+}
+
+void StartupTimeline::finish()
+{
+    if (finished || !clock.isValid()) return;
+    mark("interactive");
+    finished = true;
+
+    qint64 previous = 0;
+    for (const auto& stage : std::as_const(stages)) {
+        qDebug().noquote() << QString("[startup] %1 ms (+%2) %3")
+            .arg(stage.second, 5).arg(stage.second - previous, 4).arg(stage.first);
+        previous = stage.second;
+    }
+    stages.clear();
+}
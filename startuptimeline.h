@@ -0,0 +1,23 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+
+// Records how long each startup stage takes, measured from the top of
+// main(), and logs the whole timeline once the window is interactive.
+class StartupTimeline
+{
+public:
+    static void start();
+    static void mark(const char* stage);
+    static void finish();
+
+private:
+    static QElapsedTimer clock;
+    static QList<QPair<const char*, qint64>> stages;
+    static bool finished;
+};
+
+#endif // STARTUPTIMELINE_H